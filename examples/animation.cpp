@@ -0,0 +1,143 @@
+#include <glad/gl.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <bifrost/bifrost.h>
+#include <bifrost/bifrost_animation.h>
+#include <bifrost/bifrost_dungeon.h>
+#include <bifrost/bifrost_render.h>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// Thousands of flipbook animations cycling through runs of the dungeon sheet, advanced in
+// one Animator::Update() and recorded into a RenderQueue as a single batch. Click to spawn
+// a one-shot animation that removes itself when it finishes.
+static constexpr int ANIMATION_COUNT = 10000;
+static constexpr float SPRITE_SIZE   = 16.0f;
+
+namespace
+{
+    bifrost::Camera2d camera{};
+
+    void FramebufferSizeCallback(GLFWwindow*, int width, int height)
+    {
+        glViewport(0, 0, width, height);
+        camera = bifrost::GenUICamera(width, height);
+    }
+}
+
+int main()
+{
+    if (!glfwInit())
+        return -1;
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_SCALE_FRAMEBUFFER, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(1024, 768, "animation example", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+    glfwMakeContextCurrent(window);
+    gladLoadGL(glfwGetProcAddress);
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_BLEND);
+
+    auto screen_size = bifrost::GetScreenSize(*window);
+    glViewport(0, 0, screen_size.x, screen_size.y);
+    camera = bifrost::GenUICamera(screen_size.x, screen_size.y);
+
+    auto tileset = bifrost::GetDungeonTileset();
+    bifrost::Animator animator(tileset.texture);
+
+    // A looping clip for the first four tiles of every row of the sheet.
+    std::vector<bifrost::ClipId> clips{};
+    for (int row = 0; row < tileset.rows; row++)
+    {
+        uint16_t first = (uint16_t)(row * tileset.columns);
+        const uint16_t tiles[] = {first, (uint16_t)(first + 1), (uint16_t)(first + 2), (uint16_t)(first + 3)};
+        clips.push_back(animator.AddClip(tileset, tiles, 6.0f));
+    }
+    std::vector<uint16_t> whole_row(tileset.columns);
+    for (int col = 0; col < tileset.columns; col++)
+        whole_row[col] = (uint16_t)col;
+    bifrost::ClipId once = animator.AddClip(tileset, whole_row, 12.0f, bifrost::AnimationMode::Once);
+
+    bifrost::Seed(1234);
+    for (int i = 0; i < ANIMATION_COUNT; i++)
+    {
+        glm::vec2 position = glm::vec2(bifrost::RandomFloat(), bifrost::RandomFloat()) * camera.dimensions;
+        bifrost::AnimationId id = animator.Play(clips[bifrost::Random() % clips.size()], position, glm::vec2(SPRITE_SIZE));
+        animator.SetSpeed(id, 0.5f + bifrost::RandomFloat());
+    }
+
+    bifrost::RenderQueue queue{};
+    std::vector<bifrost::AnimationId> one_shots{};
+    double last_time = glfwGetTime();
+    double update_ms = 0.0;
+    double record_ms = 0.0;
+    bool was_pressed = false;
+
+    while (!glfwWindowShouldClose(window))
+    {
+        glfwPollEvents();
+
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+
+        double now = glfwGetTime();
+        float dt = (float)(now - last_time);
+        last_time = now;
+
+        bool pressed = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+        if (pressed && !was_pressed)
+        {
+            double mouse_x, mouse_y;
+            glfwGetCursorPos(window, &mouse_x, &mouse_y);
+            glm::vec2 mouse = glm::vec2((float)mouse_x, camera.dimensions.y - (float)mouse_y);
+            one_shots.push_back(animator.Play(once, mouse, glm::vec2(SPRITE_SIZE * 4.0f)));
+        }
+        was_pressed = pressed;
+
+        auto start = std::chrono::steady_clock::now();
+        animator.Update(dt);
+        update_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::erase_if(one_shots, [&animator](bifrost::AnimationId id)
+        {
+            if (!animator.IsFinished(id))
+                return false;
+            animator.Stop(id);
+            return true;
+        });
+
+        glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        start = std::chrono::steady_clock::now();
+        animator.Draw(queue, 0, camera);
+        record_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        char text[160];
+        snprintf(text, sizeof(text), "%zu animations, %d batches, %d culled\nupdate %.3f ms  record %.3f ms", animator.Size(),
+                 queue.LastBatchCount(), queue.LastCulledCount(), update_ms, record_ms);
+        queue.DrawRectangle(1, glm::vec2(200.0f, camera.dimensions.y - 40.0f), glm::vec2(400.0f, 64.0f), 0.0f, glm::vec4(0.0f, 0.0f, 0.0f, 0.6f));
+        queue.DrawDebugText(2, glm::vec2(10.0f, camera.dimensions.y - 30.0f), 16.0f, glm::vec4(1.0f), text);
+        queue.Execute(camera);
+
+        glfwSwapBuffers(window);
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
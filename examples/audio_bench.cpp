@@ -0,0 +1,147 @@
+#include <bifrost/bifrost_audio.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Headless benchmark: mixes an increasing number of looping voices, each with its own
+// pitch and a world position that moves every game frame, and reports what mixing costs
+// per voice. A quarter of the emitters orbit out of earshot and get culled.
+// The mixer is driven directly instead of through a device, so it runs as fast as it can
+// on machines without sound hardware; a last pass checks the same load on miniaudio's null
+// backend, which mixes on its own thread at real-time pace.
+static constexpr uint32_t SAMPLE_RATE       = 48000;
+static constexpr uint32_t BLOCK_FRAMES      = 480;  // a 10ms device period
+static constexpr int      AUDIO_SECONDS     = 20;
+static constexpr int      BLOCKS_PER_UPDATE = 2;    // move the voices about once a 60Hz frame
+
+namespace
+{
+    double ElapsedMs(std::chrono::steady_clock::time_point since)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    }
+
+    void Append(std::vector<unsigned char>& out, const void* data, size_t size)
+    {
+        auto bytes = static_cast<const unsigned char*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    // A one second 16-bit stereo WAV, so the benchmark needs no assets and the sound goes
+    // through the same decode path as real ones.
+    std::vector<unsigned char> GenToneWav(float frequency)
+    {
+        uint32_t frame_count = SAMPLE_RATE;
+        uint32_t data_size = frame_count * 4;
+        uint32_t riff_size = 36 + data_size;
+        uint32_t fmt_size = 16;
+        uint16_t format = 1, channels = 2, block_align = 4, bits = 16;
+        uint32_t sample_rate = SAMPLE_RATE, byte_rate = SAMPLE_RATE * 4;
+
+        std::vector<unsigned char> wav{};
+        Append(wav, "RIFF", 4);
+        Append(wav, &riff_size, 4);
+        Append(wav, "WAVEfmt ", 8);
+        Append(wav, &fmt_size, 4);
+        Append(wav, &format, 2);
+        Append(wav, &channels, 2);
+        Append(wav, &sample_rate, 4);
+        Append(wav, &byte_rate, 4);
+        Append(wav, &block_align, 2);
+        Append(wav, &bits, 2);
+        Append(wav, "data", 4);
+        Append(wav, &data_size, 4);
+        for (uint32_t i = 0; i < frame_count; i++)
+        {
+            int16_t sample = (int16_t)(std::sin(6.2831853f * frequency * i / SAMPLE_RATE) * 8000.0f);
+            Append(wav, &sample, 2);
+            Append(wav, &sample, 2);
+        }
+        return wav;
+    }
+
+    struct Result
+    {
+        double mix_ms;
+        double update_ms;
+        uint64_t frames;
+        int culled;
+    };
+
+    Result Run(int voice_count, const std::vector<unsigned char>& wav)
+    {
+        bifrost::AudioSystem audio({voice_count, SAMPLE_RATE, bifrost::AudioOutput::Offline});
+        bifrost::Sound sound = audio.LoadSound(wav);
+        bifrost::Camera2d camera = bifrost::GenOrthogonalCamera2d({0.0f, 0.0f}, {640.0f, 360.0f});
+        glm::vec2 center{320.0f, 180.0f};
+        audio.UpdateListener(camera);
+
+        // Every fourth voice plays unpitched, the rest spread over an octave either way.
+        // Orbits reach from the middle of the screen to well past the audible radius.
+        std::vector<bifrost::Voice> voices{};
+        std::vector<float> orbits{};
+        for (int i = 0; i < voice_count; i++)
+        {
+            float pitch = i % 4 == 0 ? 1.0f : std::exp2((float)(i % 25 - 12) / 12.0f);
+            orbits.push_back(i % 4 == 3 ? 800.0f : 40.0f + (float)(i % 16) * 20.0f);
+            voices.push_back(audio.PlaySoundAt(sound, center + glm::vec2(orbits[i], 0.0f), {0.5f, 0.0f, pitch, 0, true}));
+        }
+
+        std::vector<float> out(BLOCK_FRAMES * 2);
+        int block_count = AUDIO_SECONDS * SAMPLE_RATE / BLOCK_FRAMES;
+        double mix_ms = 0.0;
+        double update_ms = 0.0;
+        for (int block = 0; block < block_count; block++)
+        {
+            if (block % BLOCKS_PER_UPDATE == 0)
+            {
+                auto start = std::chrono::steady_clock::now();
+                float t = (float)block * BLOCK_FRAMES / SAMPLE_RATE;
+                for (int i = 0; i < voice_count; i++)
+                    audio.SetVoicePosition(voices[i], center + orbits[i] * glm::vec2(std::cos(t + (float)i), std::sin(t + (float)i)));
+                audio.UpdateListener(camera);
+                update_ms += ElapsedMs(start);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            audio.Mix(out.data(), BLOCK_FRAMES);
+            mix_ms += ElapsedMs(start);
+        }
+        return {mix_ms, update_ms, (uint64_t)block_count * BLOCK_FRAMES, audio.GetStats().culled_voices};
+    }
+}
+
+int main()
+{
+    std::vector<unsigned char> wav = GenToneWav(440.0f);
+
+    printf("%d seconds of audio at %u Hz in %u frame blocks\n\n", AUDIO_SECONDS, SAMPLE_RATE, BLOCK_FRAMES);
+    printf("%-8s %12s %16s %20s %14s %8s %14s\n", "voices", "mix", "per audio sec", "per voice per sec", "realtime", "culled", "updates");
+
+    for (int voice_count : {1, 8, 32, 64, 128, 256})
+    {
+        Run(voice_count, wav); // warm up caches and the allocator
+        Result result = Run(voice_count, wav);
+
+        double audio_seconds = (double)result.frames / SAMPLE_RATE;
+        double ms_per_second = result.mix_ms / audio_seconds;
+        printf("%-8d %9.2f ms %13.3f ms %17.2f us %13.0fx %8d %11.2f ms\n", voice_count, result.mix_ms, ms_per_second,
+               ms_per_second * 1000.0 / voice_count, audio_seconds * 1000.0 / result.mix_ms, result.culled, result.update_ms);
+    }
+
+    bifrost::AudioSystem device({256, SAMPLE_RATE, bifrost::AudioOutput::Null});
+    if (device.IsOpen())
+    {
+        bifrost::Sound sound = device.LoadSound(wav);
+        for (int i = 0; i < 256; i++)
+            device.PlaySound(sound, {0.5f, 0.0f, i % 4 == 0 ? 1.0f : 1.5f, 0, true});
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        auto stats = device.GetStats();
+        printf("\nnull device: %d voices, %.3f ms last mix\n", stats.active_voices, stats.mix_ms);
+    }
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <glad/gl.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <bifrost/bifrost.h>
+#include <bifrost/bifrost_camera.h>
+#include <bifrost/bifrost_dungeon.h>
+#include <bifrost/bifrost_input.h>
+#include <bifrost/bifrost_tilemap.h>
+
+#include <cmath>
+#include <vector>
+
+// A generated dungeon much larger than the window, seen through a Camera that follows the
+// player. WASD moves, Q/E zoom, Z/X rotate, space shakes, and clicking drops a marker at
+// the world position under the cursor. The text stays on a plain UI camera.
+static constexpr int   MAP_SIZE    = 160;
+static constexpr float TILE_SIZE   = 32.0f;
+static constexpr float PLAYER_SIZE = 24.0f;
+static constexpr uint16_t FLOOR_TILE = 0;
+static constexpr uint16_t WALL_TILE  = 40;
+
+namespace
+{
+    bifrost::Camera2d ui_camera{};
+    bifrost::Camera* world_camera = nullptr;
+
+    void FramebufferSizeCallback(GLFWwindow*, int width, int height)
+    {
+        glViewport(0, 0, width, height);
+        ui_camera = bifrost::GenUICamera(width, height);
+        world_camera->SetViewport(glm::vec2((float)width, (float)height));
+    }
+}
+
+int main()
+{
+    if (!glfwInit())
+        return -1;
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_SCALE_FRAMEBUFFER, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(1024, 768, "camera example", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+    gladLoadGL(glfwGetProcAddress);
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_BLEND);
+
+    auto screen_size = bifrost::GetScreenSize(*window);
+    glViewport(0, 0, screen_size.x, screen_size.y);
+    ui_camera = bifrost::GenUICamera(screen_size.x, screen_size.y);
+
+    bifrost::Seed(1234);
+    bifrost::DungeonParams params{};
+    params.width = MAP_SIZE;
+    params.height = MAP_SIZE;
+    auto dungeon = bifrost::GenDungeon(params);
+    bifrost::Tilemap map(MAP_SIZE, MAP_SIZE, bifrost::GetDungeonTileset(), glm::vec2(TILE_SIZE));
+    map.SetTiles(bifrost::GetDungeonTiles(dungeon, FLOOR_TILE, WALL_TILE));
+
+    glm::vec2 player{};
+    for (int i = 0; i < MAP_SIZE * MAP_SIZE; i++)
+    {
+        if (bifrost::GetDungeonCell(dungeon, i % MAP_SIZE, i / MAP_SIZE) == bifrost::DungeonCell::Floor)
+        {
+            player = map.TileToWorld(glm::ivec2(i % MAP_SIZE, i / MAP_SIZE)) + TILE_SIZE / 2.0f;
+            break;
+        }
+    }
+
+    bifrost::Camera camera(glm::vec2(screen_size), player, 1.0f);
+    world_camera = &camera;
+    glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+
+    bifrost::InputHandler input{};
+    input.AddKeyBind(GLFW_KEY_W, "up");
+    input.AddKeyBind(GLFW_KEY_S, "down");
+    input.AddKeyBind(GLFW_KEY_A, "left");
+    input.AddKeyBind(GLFW_KEY_D, "right");
+    input.AddKeyBind(GLFW_KEY_Q, "zoom_out");
+    input.AddKeyBind(GLFW_KEY_E, "zoom_in");
+    input.AddKeyBind(GLFW_KEY_Z, "rotate_left");
+    input.AddKeyBind(GLFW_KEY_X, "rotate_right");
+    input.AddKeyBind(GLFW_KEY_SPACE, "shake");
+    input.AddMouseButtonBind(GLFW_MOUSE_BUTTON_LEFT, "mark");
+    input.AddKeyBind(GLFW_KEY_ESCAPE, "quit");
+    input.BindOnPressed("quit", [&window]() { glfwSetWindowShouldClose(window, GLFW_TRUE); });
+    input.BindOnPressed("shake", [&camera]() { camera.Shake(12.0f, 0.5f); });
+
+    std::vector<glm::vec2> markers{};
+    input.BindOnPressed("mark", [&]() { markers.push_back(camera.ScreenToWorld(input.MouseAt)); });
+
+    const float speed = 300.0f;
+    double last_time = glfwGetTime();
+
+    while (!glfwWindowShouldClose(window))
+    {
+        input.PollEvents(window);
+
+        double now = glfwGetTime();
+        float dt = (float)(now - last_time);
+        last_time = now;
+
+        // Move relative to the screen, so up is up however the camera is turned.
+        glm::vec2 move = input.GetAxis("left", "right", "down", "up");
+        float turn = glm::radians(camera.GetRotation());
+        glm::vec2 screen_right = glm::vec2(std::cos(turn), -std::sin(turn));
+        glm::vec2 screen_up = glm::vec2(std::sin(turn), std::cos(turn));
+        player += (move.x * screen_right + move.y * screen_up) * speed * dt;
+
+        float zoom = input.GetAxis("zoom_out", "zoom_in");
+        if (zoom != 0.0f)
+            camera.SetZoom(camera.GetZoom() * std::exp(zoom * dt));
+        float rotate = input.GetAxis("rotate_left", "rotate_right");
+        if (rotate != 0.0f)
+            camera.SetRotation(camera.GetRotation() + rotate * 60.0f * dt);
+
+        camera.Follow(player, 6.0f, glm::vec2(TILE_SIZE));
+        camera.Update(dt);
+
+        glClearColor(0.05f, 0.05f, 0.08f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        const bifrost::Camera2d& view = camera.Get();
+        map.Draw(view);
+        for (glm::vec2 marker : markers)
+            bifrost::DrawRectangle(view, marker, glm::vec2(10.0f), 45.0f, glm::vec4(1.0f, 0.8f, 0.2f, 1.0f));
+        bifrost::DrawRectangle(view, player, glm::vec2(PLAYER_SIZE), camera.GetRotation(), glm::vec4(0.2f, 0.6f, 1.0f, 1.0f));
+
+        glm::vec2 mouse = camera.ScreenToWorld(input.MouseAt);
+        bifrost::DrawDebugText(ui_camera, glm::vec2(10.0f, ui_camera.dimensions.y - 30.0f), 16.0f, glm::vec4(1.0f),
+                               "WASD move  Q/E zoom %.2f  Z/X rotate %.0f  space shake  click mark\nmouse (%.0f, %.0f) tile (%d, %d)",
+                               camera.GetZoom(), camera.GetRotation(), mouse.x, mouse.y, map.WorldToTile(mouse).x, map.WorldToTile(mouse).y);
+
+        glfwSwapBuffers(window);
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
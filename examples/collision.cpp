@@ -5,6 +5,8 @@
 #include <bifrost/bifrost.h>
 #include <bifrost/bifrost_input.h>
 #include <bifrost/bifrost_collision.h>
+#include <bifrost/bifrost_ecs.h>
+#include <bifrost/bifrost_loop.h>
 
 namespace
 {
@@ -53,59 +55,80 @@ int main()
     input.AddKeyBind(GLFW_KEY_ESCAPE, "quit");
     input.BindOnPressed("quit", [&window]() { glfwSetWindowShouldClose(window, GLFW_TRUE); });
 
-    // Player: moves with WASD, pushed out of the wall on overlap
-    glm::vec2 player_size = glm::vec2(40.0f);
-    glm::vec2 player_pos  = camera.dimensions / 2.0f - glm::vec2(80.0f, 0.0f);
-    auto player_hitbox    = bifrost::GenRectHitbox(player_size);
-
-    // Static wall in the center of the screen
-    glm::vec2 wall_size = glm::vec2(30.0f, 160.0f);
-    glm::vec2 wall_pos  = camera.dimensions / 2.0f;
-    auto wall_hitbox    = bifrost::GenRectHitbox(wall_size);
-
+    // Player: moves with WASD, pushed out of the walls on overlap
+    bifrost::World world{};
+    bifrost::RenderQueue queue{};
+    const glm::vec2 player_size = glm::vec2(40.0f);
+    const glm::vec4 player_color = glm::vec4(0.2f, 0.6f, 1.0f, 1.0f);
+    bifrost::Entity player = world.Create(
+        bifrost::Transform{camera.dimensions / 2.0f - glm::vec2(80.0f, 0.0f)},
+        bifrost::Sprite{player_size, player_color},
+        bifrost::GenRectHitbox(player_size));
+
+    // Static walls: one in the center of the screen, a tilted one to the right
+    const glm::vec2 wall_size = glm::vec2(30.0f, 160.0f);
+    const glm::vec4 wall_color = glm::vec4(0.5f, 0.5f, 0.55f, 1.0f);
+    world.Create(bifrost::Transform{camera.dimensions / 2.0f}, bifrost::Sprite{wall_size, wall_color}, bifrost::GenRectHitbox(wall_size));
+    world.Create(bifrost::Transform{camera.dimensions / 2.0f + glm::vec2(160.0f, 0.0f), 30.0f}, bifrost::Sprite{wall_size, wall_color},
+                 bifrost::GenRectHitbox(wall_size));
+
+    // Movement and collision run at a fixed 60 Hz; rendering interpolates between the last
+    // two positions so motion stays smooth at any refresh rate.
     const float speed = 220.0f;
-    float last_time = glfwGetTime();
-
-    while (!glfwWindowShouldClose(window))
-    {
-        float now = glfwGetTime();
-        float dt  = now - last_time;
-        last_time = now;
-
-        input.PollEvents(window);
-
-        glm::vec2 move = input.GetAxis("left", "right", "down", "up");
-        player_pos += move * speed * dt;
-
-        // Resolve overlap: push the player out by the penetration vector
-        auto result = bifrost::GetCollision(player_hitbox, player_pos, 0.0f,
-                                            wall_hitbox,   wall_pos,   0.0f);
-        if (result.hit)
-            player_pos += result.penetration;
-
-        glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        // Draw wall
-        bifrost::DrawRectangle(camera, wall_pos, wall_size, glm::vec4(0.5f, 0.5f, 0.55f, 1.0f));
-        bifrost::DrawHitbox(camera, wall_hitbox, wall_pos, 0.0f, glm::vec3(0.4f, 0.4f, 0.5f));
-
-        // Draw player, tinted red while colliding
-        auto player_color = result.hit
-            ? glm::vec4(1.0f, 0.3f, 0.3f, 1.0f)
-            : glm::vec4(0.2f, 0.6f, 1.0f, 1.0f);
-        bifrost::DrawRectangle(camera, player_pos, player_size, player_color);
-        bifrost::DrawHitbox(camera, player_hitbox, player_pos, 0.0f, glm::vec3(0.0f, 1.0f, 0.0f));
-
-        bifrost::DrawDebugText(camera, glm::vec2(10.0f, camera.dimensions.y - 32.0f), 24.0f,
-                               "collision example -- WASD to move");
-        bifrost::DrawDebugText(camera, glm::vec2(10.0f, 10.0f), 24.0f,
-                               glm::vec3(0.8f, 0.8f, 0.8f),
-                               result.hit ? "HIT  penetration: (%.1f, %.1f)" : "no collision",
-                               result.penetration.x, result.penetration.y);
-
-        glfwSwapBuffers(window);
-    }
+    glm::vec2 previous_pos = world.Get<bifrost::Transform>(player)->position;
+    bifrost::CollisionResult result{};
+
+    bifrost::GameLoop loop(
+        [&](float dt)
+        {
+            auto& transform = *world.Get<bifrost::Transform>(player);
+            previous_pos = transform.position;
+
+            glm::vec2 move = input.GetAxis("left", "right", "down", "up");
+            transform.position += move * speed * dt;
+
+            // Resolve overlap: push the player out by each wall's penetration vector
+            result = {};
+            bifrost::ForEachCollision(world, player, [&](bifrost::Entity, const bifrost::CollisionResult& hit)
+            {
+                transform.position += hit.penetration;
+                result = hit;
+            });
+        },
+        [&](float alpha)
+        {
+            glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            // DrawSprites reads the Transform, so move the player to its interpolated position
+            // for the draw and back afterwards. Tinted red while colliding.
+            auto& transform = *world.Get<bifrost::Transform>(player);
+            glm::vec2 current_pos = transform.position;
+            transform.position = glm::mix(previous_pos, current_pos, alpha);
+            world.Get<bifrost::Sprite>(player)->color = result.hit ? glm::vec4(1.0f, 0.3f, 0.3f, 1.0f) : player_color;
+
+            bifrost::DrawSprites(world, queue);
+            queue.Execute(camera);
+            bifrost::DrawHitboxes(world, camera, glm::vec4(0.0f, 1.0f, 0.0f, 1.0f));
+            transform.position = current_pos;
+
+            bifrost::DrawDebugText(camera, glm::vec2(10.0f, camera.dimensions.y - 32.0f), 24.0f,
+                                   "collision example -- WASD to move");
+            bifrost::DrawDebugText(camera, glm::vec2(10.0f, 10.0f), 24.0f,
+                                   glm::vec3(0.8f, 0.8f, 0.8f),
+                                   result.hit ? "HIT  penetration: (%.1f, %.1f)" : "no collision",
+                                   result.penetration.x, result.penetration.y);
+        });
+    loop.SetBeginFrame([&]() { input.PollEvents(window); });
+    loop.SetPresent([&]() { glfwSwapBuffers(window); });
+    // Headless and remote sessions may have no monitor to ask; cap at 60 instead.
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = monitor ? glfwGetVideoMode(monitor) : nullptr;
+    if (mode && mode->refreshRate > 0)
+        loop.SetPacing(bifrost::FramePacing::VSync, mode->refreshRate);
+    else
+        loop.SetPacing(bifrost::FramePacing::Capped, 60.0);
+    loop.Run([&]() { return !glfwWindowShouldClose(window); });
 
     glfwDestroyWindow(window);
     glfwTerminate();
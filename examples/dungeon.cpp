@@ -5,6 +5,7 @@
 #include <bifrost/bifrost.h>
 #include <bifrost/bifrost_input.h>
 #include <bifrost/bifrost_dungeon.h>
+#include <bifrost/bifrost_tilemap.h>
 
 // The dungeon texture is a 12x11 grid of 16x16 tiles with 1px gaps (17px stride).
 static constexpr int   TILE_COLS   = 12;
@@ -57,7 +58,14 @@ int main()
     glViewport(0, 0, screen_size.x, screen_size.y);
     camera = bifrost::GenUICamera(screen_size.x, screen_size.y);
 
-    auto dungeon = bifrost::GetDungeonTexture();
+    auto tileset = bifrost::GetDungeonTileset();
+    auto dungeon = tileset.texture;
+
+    // One tile per atlas entry; drawn as a single chunk instead of one call per tile.
+    bifrost::Tilemap sheet(TILE_COLS, TILE_ROWS, tileset, glm::vec2(TILE_DRAW), glm::vec2(16.0f));
+    for (int row = 0; row < TILE_ROWS; row++)
+        for (int col = 0; col < TILE_COLS; col++)
+            sheet.SetTile(col, row, (uint16_t)(row * TILE_COLS + col));
 
     bifrost::InputHandler input{};
     input.AddKeyBind(GLFW_KEY_RIGHT, "right");
@@ -82,21 +90,12 @@ int main()
         glClear(GL_COLOR_BUFFER_BIT);
 
         // --- Sheet view (bottom-left) ---
-        // Draw the full atlas, tile by tile, so each tile is visible at TILE_DRAW size.
+        // The full atlas as a tilemap, so each tile is visible at TILE_DRAW size.
         const float sheet_x = 16.0f;
         const float sheet_y = 16.0f;
         const float half    = TILE_DRAW / 2.0f;
 
-        for (int row = 0; row < TILE_ROWS; row++)
-        {
-            for (int col = 0; col < TILE_COLS; col++)
-            {
-                glm::vec2 pos = glm::vec2(sheet_x + col * TILE_DRAW + half,
-                                          sheet_y + row * TILE_DRAW + half);
-                bifrost::DrawRectangle(camera, pos, glm::vec2(TILE_DRAW), dungeon,
-                                       TileUV(col, row), glm::vec2(TILE_SRC));
-            }
-        }
+        sheet.Draw(camera);
 
         // Highlight the selected tile in the sheet
         glm::vec2 sel_pos = glm::vec2(sheet_x + sel_col * TILE_DRAW + half, sheet_y + sel_row * TILE_DRAW + half);
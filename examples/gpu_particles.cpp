@@ -0,0 +1,219 @@
+#include <glad/gl.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <bifrost/bifrost.h>
+#include <bifrost/bifrost_particles.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// A million particle fountain simulated and drawn on the GPU; B moves it between the GPU
+// and CPU backends to compare.
+//
+// --verify runs the same emitter on both backends without showing a window and checks the
+// particles agree, exiting non-zero if they don't. It needs nothing but GL 4.5, so CI
+// machines without a GPU can run it on Mesa's software rasterizer:
+//
+//     xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 ./gpu_particles --verify
+static constexpr uint32_t FOUNTAIN_PARTICLES = 1000000;
+static constexpr uint32_t VERIFY_PARTICLES   = 4096;
+static constexpr int      VERIFY_STEPS       = 180;
+
+namespace
+{
+    bifrost::Camera2d camera{};
+
+    void FramebufferSizeCallback(GLFWwindow*, int width, int height)
+    {
+        glViewport(0, 0, width, height);
+        camera = bifrost::GenUICamera(width, height);
+    }
+
+    bifrost::EmitterParams GenFountain(glm::vec2 position, uint32_t max_particles, bifrost::ParticleBackend backend)
+    {
+        bifrost::EmitterParams fountain{};
+        fountain.position = position;
+        fountain.spawn_size = glm::vec2(40.0f, 0.0f);
+        fountain.max_particles = max_particles;
+        fountain.life_min = 2.5f;
+        fountain.life_max = 3.5f;
+        fountain.rate = max_particles / 3.5f;
+        fountain.speed_min = 300.0f;
+        fountain.speed_max = 600.0f;
+        fountain.direction = 1.5707963f;
+        fountain.spread = 0.5f;
+        fountain.gravity = glm::vec2(0.0f, -300.0f);
+        fountain.drag = 0.2f;
+        fountain.color_start = glm::vec4(0.4f, 0.7f, 1.0f, 0.6f);
+        fountain.color_end = glm::vec4(0.1f, 0.2f, 0.8f, 0.0f);
+        fountain.particle_size = glm::vec2(2.0f);
+        fountain.backend = backend;
+        fountain.seed = 1234;
+        return fountain;
+    }
+
+    struct Summary
+    {
+        size_t alive;
+        glm::vec2 centroid;
+        glm::vec2 min;
+        glm::vec2 max;
+    };
+
+    Summary Summarize(const std::vector<glm::vec2>& positions)
+    {
+        Summary summary{positions.size(), glm::vec2(0.0f), glm::vec2(1e30f), glm::vec2(-1e30f)};
+        for (glm::vec2 position : positions)
+        {
+            summary.centroid += position;
+            summary.min = glm::min(summary.min, position);
+            summary.max = glm::max(summary.max, position);
+        }
+        if (!positions.empty())
+            summary.centroid /= (float)positions.size();
+        return summary;
+    }
+
+    // Same seed, same steps, one emitter per backend. The random numbers match exactly, so
+    // the only differences are the GPU's float rounding and trig, which stay well under a
+    // pixel over a few seconds. A burst half way through covers the out of band spawns.
+    int Verify()
+    {
+        bifrost::ParticleSystem particles{};
+        glm::vec2 origin{320.0f, 40.0f};
+        bifrost::EmitterId cpu = particles.AddEmitter(GenFountain(origin, VERIFY_PARTICLES, bifrost::ParticleBackend::Cpu));
+        bifrost::EmitterId gpu = particles.AddEmitter(GenFountain(origin, VERIFY_PARTICLES, bifrost::ParticleBackend::Gpu));
+
+        for (int step = 0; step < VERIFY_STEPS; step++)
+        {
+            if (step == VERIFY_STEPS / 2)
+            {
+                particles.Burst(cpu, 100);
+                particles.Burst(gpu, 100);
+            }
+            particles.Update(1.0f / 60.0f);
+        }
+
+        std::vector<glm::vec2> positions{};
+        particles.GetParticlePositions(cpu, positions);
+        Summary expected = Summarize(positions);
+        particles.GetParticlePositions(gpu, positions);
+        Summary actual = Summarize(positions);
+
+        printf("gl: %s\n", (const char*)glGetString(GL_RENDERER));
+        printf("cpu: %zu alive, centroid (%.3f, %.3f), bounds (%.3f, %.3f) - (%.3f, %.3f)\n", expected.alive, expected.centroid.x,
+               expected.centroid.y, expected.min.x, expected.min.y, expected.max.x, expected.max.y);
+        printf("gpu: %zu alive, centroid (%.3f, %.3f), bounds (%.3f, %.3f) - (%.3f, %.3f)\n", actual.alive, actual.centroid.x,
+               actual.centroid.y, actual.min.x, actual.min.y, actual.max.x, actual.max.y);
+
+        // A particle whose life lands within rounding of zero can die on one side a step
+        // before the other.
+        const float tolerance = 0.5f;
+        bool alive_match = expected.alive > 0 && std::abs((long long)expected.alive - (long long)actual.alive) <= 2;
+        bool centroid_match = glm::all(glm::lessThanEqual(glm::abs(expected.centroid - actual.centroid), glm::vec2(tolerance)));
+        bool bounds_match = glm::all(glm::lessThanEqual(glm::abs(expected.min - actual.min), glm::vec2(tolerance))) &&
+                            glm::all(glm::lessThanEqual(glm::abs(expected.max - actual.max), glm::vec2(tolerance)));
+
+        bool passed = alive_match && centroid_match && bounds_match;
+        printf("%s\n", passed ? "backends match" : "backends differ");
+        return passed ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool verify = argc > 1 && strcmp(argv[1], "--verify") == 0;
+
+    if (!glfwInit())
+        return -1;
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_SCALE_FRAMEBUFFER, GLFW_FALSE);
+    glfwWindowHint(GLFW_VISIBLE, verify ? GLFW_FALSE : GLFW_TRUE);
+
+    GLFWwindow* window = glfwCreateWindow(1024, 768, "gpu particles example", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+    glfwMakeContextCurrent(window);
+    gladLoadGL(glfwGetProcAddress);
+
+    if (verify)
+    {
+        int result = Verify();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return result;
+    }
+
+    glfwSwapInterval(1);
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_BLEND);
+
+    auto screen_size = bifrost::GetScreenSize(*window);
+    glViewport(0, 0, screen_size.x, screen_size.y);
+    camera = bifrost::GenUICamera(screen_size.x, screen_size.y);
+
+    bifrost::ParticleSystem particles{};
+    bifrost::ParticleBackend backend = bifrost::ParticleBackend::Gpu;
+    glm::vec2 origin = glm::vec2(camera.dimensions.x / 2.0f, 40.0f);
+    bifrost::EmitterId fountain_id = particles.AddEmitter(GenFountain(origin, FOUNTAIN_PARTICLES, backend));
+
+    double last_time = glfwGetTime();
+    double draw_ms = 0.0;
+    bool was_pressed = false;
+
+    while (!glfwWindowShouldClose(window))
+    {
+        glfwPollEvents();
+
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+
+        double now = glfwGetTime();
+        float dt = (float)(now - last_time);
+        last_time = now;
+
+        bool pressed = glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS;
+        if (pressed && !was_pressed)
+        {
+            backend = backend == bifrost::ParticleBackend::Gpu ? bifrost::ParticleBackend::Cpu : bifrost::ParticleBackend::Gpu;
+            particles.RemoveEmitter(fountain_id);
+            fountain_id = particles.AddEmitter(GenFountain(origin, FOUNTAIN_PARTICLES, backend));
+        }
+        was_pressed = pressed;
+
+        particles.GetParams(fountain_id)->position.x = camera.dimensions.x / 2.0f;
+        particles.Update(dt);
+
+        glClearColor(0.05f, 0.05f, 0.08f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        auto start = std::chrono::steady_clock::now();
+        particles.Draw(camera);
+        draw_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        auto stats = particles.GetStats();
+        char text[160];
+        snprintf(text, sizeof(text), "%s backend (B to switch), %zu particles\nupdate %.2f ms  draw %.2f ms",
+                 backend == bifrost::ParticleBackend::Gpu ? "gpu" : "cpu", stats.particles, stats.update_ms, draw_ms);
+        bifrost::DrawDebugText(camera, glm::vec2(10.0f, camera.dimensions.y - 30.0f), 16.0f, glm::vec4(1.0f), text);
+
+        glfwSwapBuffers(window);
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -4,6 +4,7 @@
 
 #include <bifrost/bifrost.h>
 #include <bifrost/bifrost_input.h>
+#include <bifrost/bifrost_loop.h>
 
 namespace
 {
@@ -55,29 +56,28 @@ int main()
     const float speed = 200.0f;
     glm::vec2 pos = camera.dimensions / 2.0f;
 
-    float last_time = glfwGetTime();
-
-    while (!glfwWindowShouldClose(window))
-    {
-        float now = glfwGetTime();
-        float dt = now - last_time;
-        last_time = now;
-
-        input.PollEvents(window);
-
-        glm::vec2 move = input.GetAxis("left", "right", "down", "up");
-        pos += move * speed * dt;
-
-        glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        bifrost::DrawRectangle(camera, pos, glm::vec2(60.0f), glm::vec4(0.2f, 0.6f, 1.0f, 1.0f));
-
-        bifrost::DrawDebugText(camera, glm::vec2(10.0f, camera.dimensions.y - 32.0f), 24.0f, "input example -- WASD to move");
-        bifrost::DrawDebugText(camera, glm::vec2(10.0f, 10.0f), 24.0f, glm::vec3(0.8f, 0.8f, 0.8f), "pos: (%.0f, %.0f)", pos.x, pos.y);
-
-        glfwSwapBuffers(window);
-    }
+    glm::vec2 previous_pos = pos;
+
+    bifrost::GameLoop loop(
+        [&](float dt)
+        {
+            previous_pos = pos;
+            glm::vec2 move = input.GetAxis("left", "right", "down", "up");
+            pos += move * speed * dt;
+        },
+        [&](float alpha)
+        {
+            glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            bifrost::DrawRectangle(camera, glm::mix(previous_pos, pos, alpha), glm::vec2(60.0f), glm::vec4(0.2f, 0.6f, 1.0f, 1.0f));
+
+            bifrost::DrawDebugText(camera, glm::vec2(10.0f, camera.dimensions.y - 32.0f), 24.0f, "input example -- WASD to move");
+            bifrost::DrawDebugText(camera, glm::vec2(10.0f, 10.0f), 24.0f, glm::vec3(0.8f, 0.8f, 0.8f), "pos: (%.0f, %.0f)", pos.x, pos.y);
+        });
+    loop.SetBeginFrame([&]() { input.PollEvents(window); });
+    loop.SetPresent([&]() { glfwSwapBuffers(window); });
+    loop.Run([&]() { return !glfwWindowShouldClose(window); });
 
     glfwDestroyWindow(window);
     glfwTerminate();
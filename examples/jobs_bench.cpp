@@ -0,0 +1,111 @@
+#include <bifrost/bifrost_jobs.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Headless benchmark: the same workloads on job systems with an increasing number of
+// workers, to show how ParallelFor, many tiny jobs and dependent stages scale.
+static constexpr size_t ELEMENT_COUNT = 1 << 22;
+static constexpr int    TINY_JOBS     = 100000;
+static constexpr int    STAGE_JOBS    = 64;
+
+namespace
+{
+    double ElapsedMs(std::chrono::steady_clock::time_point since)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    }
+
+    // Enough arithmetic per element that the loop is compute bound.
+    float Work(size_t i)
+    {
+        float x = (float)i * 0.001f;
+        for (int k = 0; k < 16; k++)
+            x = std::sin(x) * 0.5f + std::sqrt(x + 1.0f);
+        return x;
+    }
+
+    double ParallelForMs(bifrost::JobSystem& jobs, std::vector<float>& out)
+    {
+        auto start = std::chrono::steady_clock::now();
+        jobs.ParallelFor(out.size(), [&out](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                out[i] = Work(i);
+        }, 1024);
+        return ElapsedMs(start);
+    }
+
+    double TinyJobsMs(bifrost::JobSystem& jobs)
+    {
+        std::atomic<int> sum{0};
+        bifrost::JobCounter counter{};
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < TINY_JOBS; i++)
+            jobs.Run([&sum]() { sum.fetch_add(1, std::memory_order_relaxed); }, &counter);
+        jobs.Wait(counter);
+        return ElapsedMs(start);
+    }
+
+    // Two stages where every job in the second waits on the whole first stage.
+    double StagesMs(bifrost::JobSystem& jobs, std::vector<float>& out)
+    {
+        bifrost::JobCounter first{};
+        bifrost::JobCounter second{};
+        size_t slice = out.size() / STAGE_JOBS;
+        auto start = std::chrono::steady_clock::now();
+        for (int j = 0; j < STAGE_JOBS; j++)
+        {
+            jobs.Run([&out, j, slice]()
+            {
+                for (size_t i = j * slice; i < (j + 1) * slice; i++)
+                    out[i] = Work(i);
+            }, &first);
+        }
+        for (int j = 0; j < STAGE_JOBS; j++)
+        {
+            jobs.Run([&out, j, slice]()
+            {
+                for (size_t i = j * slice; i < (j + 1) * slice; i++)
+                    out[i] = std::sqrt(out[i] + out[out.size() - 1 - i]);
+            }, first, &second);
+        }
+        jobs.Wait(second);
+        return ElapsedMs(start);
+    }
+}
+
+int main()
+{
+    int max_workers = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+    std::vector<float> data(ELEMENT_COUNT);
+
+    printf("%-8s %14s %14s %14s %10s\n", "workers", "parallel_for", "tiny jobs", "2 stages", "speedup");
+
+    std::vector<int> worker_counts = {0};
+    for (int workers = 1; workers < max_workers; workers *= 2)
+        worker_counts.push_back(workers);
+    worker_counts.push_back(max_workers);
+
+    double baseline = 0.0;
+    for (int workers : worker_counts)
+    {
+        bifrost::JobSystem jobs(workers);
+        ParallelForMs(jobs, data); // warm up threads and caches
+
+        double parallel_for = ParallelForMs(jobs, data);
+        double tiny = TinyJobsMs(jobs);
+        double stages = StagesMs(jobs, data);
+        if (workers == 0)
+            baseline = parallel_for;
+
+        printf("%-8d %11.2f ms %11.2f ms %11.2f ms %9.2fx\n", workers, parallel_for, tiny, stages, baseline / parallel_for);
+    }
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include <glad/gl.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <bifrost/bifrost.h>
+#include <bifrost/bifrost_particles.h>
+
+#include <chrono>
+#include <cstdio>
+
+// A fountain big enough to need the SIMD update and the job system, a fire that follows
+// the mouse and sparks on click, each emitter drawn with one instanced call.
+static constexpr uint32_t FOUNTAIN_PARTICLES = 200000;
+
+namespace
+{
+    bifrost::Camera2d camera{};
+
+    void FramebufferSizeCallback(GLFWwindow*, int width, int height)
+    {
+        glViewport(0, 0, width, height);
+        camera = bifrost::GenUICamera(width, height);
+    }
+}
+
+int main()
+{
+    if (!glfwInit())
+        return -1;
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_SCALE_FRAMEBUFFER, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(1024, 768, "particles example", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+    glfwMakeContextCurrent(window);
+    gladLoadGL(glfwGetProcAddress);
+    glfwSwapInterval(1);
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_BLEND);
+
+    auto screen_size = bifrost::GetScreenSize(*window);
+    glViewport(0, 0, screen_size.x, screen_size.y);
+    camera = bifrost::GenUICamera(screen_size.x, screen_size.y);
+
+    bifrost::ParticleSystem particles{};
+
+    bifrost::EmitterParams fountain{};
+    fountain.position = glm::vec2(camera.dimensions.x / 2.0f, 40.0f);
+    fountain.spawn_size = glm::vec2(40.0f, 0.0f);
+    fountain.max_particles = FOUNTAIN_PARTICLES;
+    fountain.life_min = 2.5f;
+    fountain.life_max = 3.5f;
+    fountain.rate = FOUNTAIN_PARTICLES / 3.5f;
+    fountain.speed_min = 300.0f;
+    fountain.speed_max = 600.0f;
+    fountain.direction = 1.5707963f;
+    fountain.spread = 0.5f;
+    fountain.gravity = glm::vec2(0.0f, -300.0f);
+    fountain.color_start = glm::vec4(0.4f, 0.7f, 1.0f, 0.6f);
+    fountain.color_end = glm::vec4(0.1f, 0.2f, 0.8f, 0.0f);
+    fountain.particle_size = glm::vec2(2.0f);
+    bifrost::EmitterId fountain_id = particles.AddEmitter(fountain);
+
+    bifrost::EmitterParams fire{};
+    fire.max_particles = 4096;
+    fire.rate = 1500.0f;
+    fire.life_min = 0.4f;
+    fire.life_max = 0.9f;
+    fire.speed_min = 40.0f;
+    fire.speed_max = 120.0f;
+    fire.direction = 1.5707963f;
+    fire.spread = 0.8f;
+    fire.spawn_size = glm::vec2(16.0f, 4.0f);
+    fire.gravity = glm::vec2(0.0f, 150.0f);
+    fire.drag = 1.5f;
+    fire.color_start = glm::vec4(1.0f, 0.8f, 0.3f, 1.0f);
+    fire.color_end = glm::vec4(0.8f, 0.1f, 0.0f, 0.0f);
+    fire.particle_size = glm::vec2(6.0f);
+    fire.additive = true;
+    bifrost::EmitterId fire_id = particles.AddEmitter(fire);
+
+    bifrost::EmitterParams sparks = fire;
+    sparks.rate = 0.0f;
+    sparks.max_particles = 8192;
+    sparks.speed_min = 200.0f;
+    sparks.speed_max = 500.0f;
+    sparks.spread = 6.2831853f;
+    sparks.spawn_size = glm::vec2(0.0f);
+    sparks.gravity = glm::vec2(0.0f, -400.0f);
+    sparks.drag = 0.8f;
+    sparks.color_start = glm::vec4(1.0f, 1.0f, 0.6f, 1.0f);
+    sparks.particle_size = glm::vec2(3.0f);
+    bifrost::EmitterId sparks_id = particles.AddEmitter(sparks);
+
+    double last_time = glfwGetTime();
+    double draw_ms = 0.0;
+    bool was_pressed = false;
+
+    while (!glfwWindowShouldClose(window))
+    {
+        glfwPollEvents();
+
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+
+        double now = glfwGetTime();
+        float dt = (float)(now - last_time);
+        last_time = now;
+
+        double mouse_x, mouse_y;
+        glfwGetCursorPos(window, &mouse_x, &mouse_y);
+        glm::vec2 mouse = glm::vec2((float)mouse_x, camera.dimensions.y - (float)mouse_y);
+
+        particles.GetParams(fountain_id)->position.x = camera.dimensions.x / 2.0f;
+        particles.GetParams(fire_id)->position = mouse;
+        particles.GetParams(sparks_id)->position = mouse;
+        bool pressed = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+        if (pressed && !was_pressed)
+            particles.Burst(sparks_id, 600);
+        was_pressed = pressed;
+
+        particles.Update(dt);
+
+        glClearColor(0.05f, 0.05f, 0.08f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        auto start = std::chrono::steady_clock::now();
+        particles.Draw(camera);
+        draw_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        auto stats = particles.GetStats();
+        char text[128];
+        snprintf(text, sizeof(text), "%zu particles, %zu emitters\nupdate %.2f ms  draw %.2f ms", stats.particles, stats.emitters,
+                 stats.update_ms, draw_ms);
+        bifrost::DrawDebugText(camera, glm::vec2(10.0f, camera.dimensions.y - 30.0f), 16.0f, glm::vec4(1.0f), text);
+
+        glfwSwapBuffers(window);
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <bifrost/bifrost.h>
+#include <bifrost/bifrost_collision.h>
+#include <bifrost/bifrost_dungeon.h>
+#include <bifrost/bifrost_pathfinding.h>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Headless benchmark: 2,000 agents on a generated 512x512 dungeon, pathing either
+// individually (JPS, serial and through the PathfindingService) or towards a few shared
+// goals with flow fields.
+static constexpr int MAP_SIZE    = 512;
+static constexpr int AGENT_COUNT = 2000;
+static constexpr int GOAL_COUNT  = 8;
+
+namespace
+{
+    double ElapsedMs(std::chrono::steady_clock::time_point since)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    }
+}
+
+int main()
+{
+    bifrost::Seed(2024);
+
+    auto start = std::chrono::steady_clock::now();
+    bifrost::DungeonParams params{};
+    params.width = MAP_SIZE;
+    params.height = MAP_SIZE;
+    auto map = bifrost::GenDungeon(params);
+    auto grid = bifrost::GenTileCollisionGrid(map.width, map.height, glm::vec2(1.0f), glm::vec2(0.0f),
+        [&map](int x, int y) { return bifrost::IsDungeonCellSolid(bifrost::GetDungeonCell(map, x, y)); });
+    printf("map %dx%d generated in %.2f ms\n", MAP_SIZE, MAP_SIZE, ElapsedMs(start));
+
+    std::vector<glm::ivec2> floors{};
+    for (int y = 0; y < map.height; y++)
+        for (int x = 0; x < map.width; x++)
+            if (!bifrost::IsTileSolid(grid, x, y))
+                floors.push_back({x, y});
+
+    std::vector<glm::ivec2> agents(AGENT_COUNT);
+    for (auto& agent : agents)
+        agent = floors[bifrost::Random() % floors.size()];
+
+    std::vector<glm::ivec2> goals(GOAL_COUNT);
+    for (auto& goal : goals)
+        goal = floors[bifrost::Random() % floors.size()];
+
+    // --- Serial JPS ---
+    start = std::chrono::steady_clock::now();
+    size_t waypoints = 0;
+    int found = 0;
+    for (int i = 0; i < AGENT_COUNT; i++)
+    {
+        auto path = bifrost::FindPath(grid, agents[i], goals[i % GOAL_COUNT]);
+        waypoints += path.size();
+        found += !path.empty();
+    }
+    double serial_ms = ElapsedMs(start);
+    printf("jps serial:   %d paths (%d found, %zu jump points) in %.2f ms, %.1f us/path\n",
+           AGENT_COUNT, found, waypoints, serial_ms, serial_ms * 1000.0 / AGENT_COUNT);
+
+    // --- PathfindingService, one Update() per simulated frame ---
+    {
+        bifrost::PathfindingService service(grid);
+        std::vector<uint32_t> requests(AGENT_COUNT);
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < AGENT_COUNT; i++)
+            requests[i] = service.RequestPath(agents[i], goals[i % GOAL_COUNT]);
+
+        int frames = 0;
+        int remaining = AGENT_COUNT;
+        std::vector<glm::ivec2> path{};
+        while (remaining)
+        {
+            service.Update();
+            frames++;
+            // Stand-in for the rest of the frame, so polling doesn't compete with the workers.
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            for (auto& request : requests)
+            {
+                if (request && service.GetPath(request, path))
+                {
+                    request = 0;
+                    remaining--;
+                }
+            }
+        }
+        double service_ms = ElapsedMs(start);
+        printf("jps service:  %d paths over %d updates in %.2f ms\n", AGENT_COUNT, frames, service_ms);
+    }
+
+    // --- Flow fields, one per shared goal ---
+    {
+        bifrost::PathfindingService service(grid);
+        start = std::chrono::steady_clock::now();
+        for (const auto& goal : goals)
+            service.GetFlowField(goal);
+        service.Flush();
+        double build_ms = ElapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        glm::vec2 sum{0.0f};
+        for (int i = 0; i < AGENT_COUNT; i++)
+        {
+            auto field = service.GetFlowField(goals[i % GOAL_COUNT]);
+            sum += bifrost::GetFlowDirection(*field, agents[i]);
+        }
+        double lookup_ms = ElapsedMs(start);
+        printf("flow fields:  %d goals built in %.2f ms, %d agent lookups in %.3f ms (checksum %.2f)\n",
+               GOAL_COUNT, build_ms, AGENT_COUNT, lookup_ms, sum.x + sum.y);
+    }
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <glad/gl.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <bifrost/bifrost.h>
+#include <bifrost/bifrost_jobs.h>
+#include <bifrost/bifrost_render.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Thousands of sprites, lines and labels recorded from worker threads into a RenderQueue,
+// then drawn from the main thread in a handful of batches.
+static constexpr int SPRITE_COUNT = 20000;
+
+namespace
+{
+    bifrost::Camera2d camera{};
+
+    void FramebufferSizeCallback(GLFWwindow*, int width, int height)
+    {
+        glViewport(0, 0, width, height);
+        camera = bifrost::GenUICamera(width, height);
+    }
+
+    struct Sprite
+    {
+        glm::vec2 position;
+        glm::vec2 velocity;
+        glm::vec4 color;
+    };
+}
+
+int main()
+{
+    if (!glfwInit())
+        return -1;
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_SCALE_FRAMEBUFFER, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(1024, 768, "render queue example", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+    glfwMakeContextCurrent(window);
+    gladLoadGL(glfwGetProcAddress);
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_BLEND);
+
+    auto screen_size = bifrost::GetScreenSize(*window);
+    glViewport(0, 0, screen_size.x, screen_size.y);
+    camera = bifrost::GenUICamera(screen_size.x, screen_size.y);
+
+    bifrost::Seed(1234);
+    std::vector<Sprite> sprites(SPRITE_COUNT);
+    for (auto& sprite : sprites)
+    {
+        sprite.position = glm::vec2(bifrost::RandomFloat(), bifrost::RandomFloat()) * camera.dimensions;
+        sprite.velocity = (glm::vec2(bifrost::RandomFloat(), bifrost::RandomFloat()) - 0.5f) * 200.0f;
+        sprite.color = glm::vec4(bifrost::RandomFloat(), bifrost::RandomFloat(), bifrost::RandomFloat(), 0.8f);
+    }
+
+    auto& jobs = bifrost::GetJobSystem();
+    bifrost::RenderQueue queue{};
+    bifrost::RenderQueue ui_queue{};
+
+    double last_time = glfwGetTime();
+    double record_ms = 0.0;
+    double execute_ms = 0.0;
+
+    while (!glfwWindowShouldClose(window))
+    {
+        glfwPollEvents();
+
+        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+
+        double now = glfwGetTime();
+        float dt = (float)(now - last_time);
+        last_time = now;
+
+        glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // Update and record in parallel; every worker writes to its own command buffer.
+        auto start = std::chrono::steady_clock::now();
+        glm::vec2 bounds = camera.dimensions;
+        jobs.ParallelFor(sprites.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                auto& sprite = sprites[i];
+                sprite.position += sprite.velocity * dt;
+                sprite.position = glm::mod(sprite.position + bounds, bounds);
+
+                queue.DrawRectangle(0, sprite.position, glm::vec2(6.0f), 0.0f, sprite.color);
+                if (i % 100 == 0)
+                {
+                    queue.DrawLine(1, sprite.position, sprite.position + sprite.velocity * 0.25f, 2.0f, glm::vec4(1.0f));
+                    queue.DrawDebugText(2, sprite.position + glm::vec2(6.0f), 12.0f, glm::vec4(1.0f, 1.0f, 0.6f, 1.0f), "sprite");
+                }
+            }
+        }, 256);
+        record_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        queue.Execute(camera);
+        execute_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        ui_queue.DrawRectangle(0, glm::vec2(200.0f, camera.dimensions.y - 40.0f), glm::vec2(400.0f, 64.0f), 0.0f, glm::vec4(0.0f, 0.0f, 0.0f, 0.6f));
+        ui_queue.DrawDebugText(1, glm::vec2(10.0f, camera.dimensions.y - 30.0f), 16.0f, glm::vec4(1.0f),
+            std::to_string(SPRITE_COUNT) + " sprites, " + std::to_string(queue.LastBatchCount()) + " batches");
+        char timings[128];
+        snprintf(timings, sizeof(timings), "record %.2f ms  execute %.2f ms", record_ms, execute_ms);
+        ui_queue.DrawDebugText(1, glm::vec2(10.0f, camera.dimensions.y - 56.0f), 16.0f, glm::vec4(0.8f, 0.8f, 0.8f, 1.0f), timings);
+        ui_queue.Execute(camera);
+
+        glfwSwapBuffers(window);
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
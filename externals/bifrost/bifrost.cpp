@@ -1,4 +1,6 @@
 #include "bifrost.h"
+#include "bifrost_arena.h"
+#include "bifrost_btex.h"
 
 #define GLAD_GL_IMPLEMENTATION
 #include <glad/gl.h>
@@ -10,11 +12,24 @@
 #endif
 #include "stb/stb_image.h"
 
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <iterator>
+#include <limits>
 #include <sstream>
 #include <iostream>
+#include <span>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BIFROST_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace
 {
 #include "debug_font_png.h"
@@ -35,12 +50,14 @@ namespace
     unsigned int uv_quad_vbo;
     unsigned int offset_vbo;
     unsigned int uv_offset_vbo;
+    unsigned int color_vbo;
 
     bifrost::Shader basic_shader;
     bifrost::Shader texture_shader;
     bifrost::Shader uv_texture_shader;
     bifrost::Shader line_shader;
     bifrost::Shader instanced_uv_texture_shader;
+    bifrost::Shader instanced_color_texture_shader;
 
     const char* basic_vs =
 R"(#version 450 core
@@ -81,6 +98,24 @@ void main()
     gl_Position = vp * (m * vec4(position, 0.0, 1.0) + vec4(offset, 0.0, 0.0));
     texture_coords = uv + uv_offset;
 }
+)";
+
+    const char* instanced_color_vs =
+R"(#version 450 core
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 uv;
+layout (location = 2) in vec2 offset;
+layout (location = 4) in vec4 instance_color;
+out vec2 texture_coords;
+out vec4 tint;
+uniform mat4 m;
+uniform mat4 vp;
+void main()
+{
+    gl_Position = vp * (m * vec4(position, 0.0, 1.0) + vec4(offset, 0.0, 0.0));
+    texture_coords = uv;
+    tint = instance_color;
+}
 )";
 
     const char* line_to_quad_gs =
@@ -140,7 +175,19 @@ void main()
     fragment_color = texture(tex, texture_coords) * vec4(color);
 })";
 
+    const char* tinted_fs =
+R"(#version 450 core
+in vec2 texture_coords;
+in vec4 tint;
+uniform sampler2D tex;
+out vec4 fragment_color;
+void main()
+{
+    fragment_color = texture(tex, texture_coords) * tint;
+})";
+
     bifrost::Texture debug_font_texture;
+    bifrost::Texture white_texture;
     float text_wrap_width = 0.0f;
 
     uint32_t seed = 0;
@@ -168,6 +215,7 @@ namespace bifrost
             glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, (void*)0);
             glGenBuffers(1, &offset_vbo);
             glGenBuffers(1, &uv_offset_vbo);
+            glGenBuffers(1, &color_vbo);
             glBindVertexArray(0);
 
             basic_shader = bifrost::GenShaderFromSource(basic_vs, basic_fs);
@@ -175,16 +223,23 @@ namespace bifrost
             uv_texture_shader = bifrost::GenShaderFromSource(uv_vs, textured_fs);
             line_shader = bifrost::GenShaderFromSource(basic_vs, line_to_quad_gs, basic_fs);
             instanced_uv_texture_shader = bifrost::GenShaderFromSource(instanced_uv_vs, textured_fs);
+            instanced_color_texture_shader = bifrost::GenShaderFromSource(instanced_color_vs, tinted_fs);
 
             debug_font_texture = LoadTexture(debug_font_png, static_cast<int>(debug_font_png_len));
+
+            const uint32_t white = 0xFFFFFFFF;
+            white_texture = {0, 1, 1};
+            glGenTextures(1, &white_texture.id);
+            glBindTexture(GL_TEXTURE_2D, white_texture.id);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         }
 
-        void DrawRectangleInstanced(bifrost::Camera2d camera, glm::vec2 origin, glm::vec2 size, bifrost::Texture texture, glm::vec2 source_origin, glm::vec2 source_size, glm::vec4 color, const std::vector<glm::vec2>& offsets, const std::vector<glm::vec2>& uv_offsets)
+        void SetQuadUvs(bifrost::Texture texture, glm::vec2 source_origin, glm::vec2 source_size)
         {
-            InitializeDrawing();
             glm::vec2 uv_start = glm::vec2(source_origin.x / (float)texture.width, source_origin.y / (float)texture.height);
             glm::vec2 uv_end = uv_start + glm::vec2(source_size.x / (float)texture.width, source_size.y / (float)texture.height);
-            // calculate UVs
 
             float uvs[] = {
                 uv_start.x, uv_end.y,
@@ -197,12 +252,18 @@ namespace bifrost
             };
             glBindBuffer(GL_ARRAY_BUFFER, uv_quad_vbo);
             glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 12, uvs, GL_DYNAMIC_DRAW);
-        
+        }
+
+        void DrawRectangleInstanced(bifrost::Camera2d camera, glm::vec2 origin, glm::vec2 size, bifrost::Texture texture, glm::vec2 source_origin, glm::vec2 source_size, glm::vec4 color, std::span<const glm::vec2> offsets, std::span<const glm::vec2> uv_offsets)
+        {
+            InitializeDrawing();
+            SetQuadUvs(texture, source_origin, source_size);
+
             glBindBuffer(GL_ARRAY_BUFFER, offset_vbo);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * offsets.size(), &offsets[0], GL_DYNAMIC_DRAW);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * offsets.size(), offsets.data(), GL_DYNAMIC_DRAW);
 
             glBindBuffer(GL_ARRAY_BUFFER, uv_offset_vbo);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * uv_offsets.size(), &uv_offsets[0], GL_DYNAMIC_DRAW);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * uv_offsets.size(), uv_offsets.data(), GL_DYNAMIC_DRAW);
 
             auto model = glm::translate(glm::mat4(1.0f), glm::vec3(origin.x, origin.y, 0.0f));
             model = glm::scale(model, glm::vec3(size.x, size.y, 1.0f));
@@ -219,6 +280,7 @@ namespace bifrost
             glBindBuffer(GL_ARRAY_BUFFER, uv_offset_vbo);
             glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
             glVertexAttribDivisor(3, 1);
+            glDisableVertexAttribArray(4);
             
             glActiveTexture(GL_TEXTURE0);
             glBindTexture(GL_TEXTURE_2D, texture.id);
@@ -238,13 +300,17 @@ namespace bifrost
 
             glm::vec2 offset = glm::vec2(0.0f);
 
-            std::vector<glm::vec2> offsets{};
-            std::vector<glm::vec2> uvs{};
-
             glEnable(GL_BLEND);
             glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
             char buffer[1000];
-            vsnprintf(buffer, 1000, format, args);
+            int length = vsnprintf(buffer, 1000, format, args);
+
+            auto& arena = bifrost::GetFrameArena();
+            bifrost::FrameArena::Scope scope(arena);
+            bifrost::ArenaVector<glm::vec2> offsets(&arena);
+            bifrost::ArenaVector<glm::vec2> uvs(&arena);
+            offsets.reserve(std::clamp(length, 0, 999));
+            uvs.reserve(std::clamp(length, 0, 999));
 
             int i = 0;
             while(buffer[i] != '\0' && i < 1000)
@@ -259,42 +325,7 @@ namespace bifrost
                 int index = int(buffer[i]) - 32;
                 int x = index % 16;
                 int y = index / 16;
-                float char_width = 6.0f;
-                switch (buffer[i])
-                {
-                case '!':
-                case '\'':
-                case ',':
-                case '.':
-                case ':':
-                case ';':
-                case 'i':
-                case 'j':
-                case '|':
-                    char_width = 2.0f;
-                    break;
-                case 'l':
-                    char_width = 3.0f;
-                    break;
-                case '"':
-                case '(':
-                case ')':
-                case '?':
-                case 'I':
-                case '^':
-                case '{':
-                case '}':
-                    char_width = 4.0f;
-                    break;
-                case '/':
-                case '<':
-                case '>':
-                case '[':
-                case '\\':
-                case ']':
-                    char_width = 5.0f;
-                    break;
-                }
+                float char_width = GetDebugCharWidth(buffer[i]);
 
                 if (text_wrap_width > 0.0f && (offset.x + height / 12.0f * char_width) > text_wrap_width)
                 {
@@ -322,6 +353,78 @@ namespace bifrost
 
             return origin + offset;
         }
+
+        bool IsBtex(const unsigned char* data, size_t size)
+        {
+            uint32_t magic = 0;
+            if (size >= sizeof(magic))
+                memcpy(&magic, data, sizeof(magic));
+            return magic == BTEX_MAGIC;
+        }
+
+        // Uploads a cooked texture as is: immutable storage for every level, then one
+        // glTexSubImage2D or glCompressedTexSubImage2D per level straight from data.
+        Texture LoadBtexTexture(const unsigned char* data, size_t size)
+        {
+            BtexHeader header{};
+            if (size >= sizeof(header))
+                memcpy(&header, data, sizeof(header));
+
+            unsigned int internal_format = 0;
+            switch ((BtexFormat)header.format)
+            {
+                case BtexFormat::Rgba8:     internal_format = GL_RGBA8; break;
+                case BtexFormat::Bc7:       internal_format = GL_COMPRESSED_RGBA_BPTC_UNORM; break;
+                case BtexFormat::Etc2Rgba8: internal_format = GL_COMPRESSED_RGBA8_ETC2_EAC; break;
+            }
+
+            bool valid = header.version == BTEX_VERSION && internal_format != 0 && header.width > 0 && header.height > 0
+                      && header.mip_count > 0 && header.mip_count <= 32
+                      && sizeof(header) + header.mip_count * sizeof(BtexMip) <= size;
+
+            BtexMip mips[32] = {};
+            for (uint32_t level = 0; valid && level < header.mip_count; level++)
+            {
+                memcpy(&mips[level], data + sizeof(header) + level * sizeof(BtexMip), sizeof(BtexMip));
+                uint32_t width = std::max(header.width >> level, 1u);
+                uint32_t height = std::max(header.height >> level, 1u);
+                valid = mips[level].offset <= size && mips[level].size <= size - mips[level].offset
+                     && mips[level].size == GetBtexLevelSize((BtexFormat)header.format, width, height);
+            }
+
+            if (!valid)
+            {
+                fprintf(stderr, "bifrost: invalid or unsupported btex texture\n");
+                return {};
+            }
+
+            Texture texture = {};
+            glGenTextures(1, &texture.id);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, texture.id);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, header.mip_count > 1 ? GL_NEAREST_MIPMAP_LINEAR : GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)header.mip_count - 1);
+            glTexStorage2D(GL_TEXTURE_2D, (int)header.mip_count, internal_format, (int)header.width, (int)header.height);
+
+            for (uint32_t level = 0; level < header.mip_count; level++)
+            {
+                int width = (int)std::max(header.width >> level, 1u);
+                int height = (int)std::max(header.height >> level, 1u);
+                const unsigned char* pixels = data + mips[level].offset;
+                if (internal_format == GL_RGBA8)
+                    glTexSubImage2D(GL_TEXTURE_2D, (int)level, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+                else
+                    glCompressedTexSubImage2D(GL_TEXTURE_2D, (int)level, 0, 0, width, height, internal_format, (int)mips[level].size, pixels);
+            }
+
+            texture.width = header.width;
+            texture.height = header.height;
+            texture.premultiplied = (header.flags & BTEX_PREMULTIPLIED) != 0;
+            return texture;
+        }
     }
 
     Framebuffer GenFramebuffer(unsigned int width, unsigned int height, unsigned int texture_filter, unsigned int texture_wrap, unsigned int internal_format)
@@ -543,6 +646,35 @@ namespace bifrost
         return shader;
     }
 
+    Shader GenComputeShaderFromSource(const char* compute_shader)
+    {
+        Shader shader = {};
+
+        unsigned int compute_shader_id = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(compute_shader_id, 1, &compute_shader, NULL);
+        glCompileShader(compute_shader_id);
+
+        shader.id = glCreateProgram();
+        glAttachShader(shader.id, compute_shader_id);
+        glLinkProgram(shader.id);
+
+        int linked = 0;
+        glGetProgramiv(shader.id, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            char log[1024] = {};
+            glGetShaderInfoLog(compute_shader_id, sizeof(log), NULL, log);
+            if (log[0] == '\0')
+                glGetProgramInfoLog(shader.id, sizeof(log), NULL, log);
+            fprintf(stderr, "bifrost: compute shader failed to build: %s\n", log);
+            glDeleteProgram(shader.id);
+            shader.id = 0;
+        }
+
+        glDeleteShader(compute_shader_id);
+        return shader;
+    }
+
     unsigned int GenVec4Vao(const float vertices[], const unsigned int vertex_count)
     {
         unsigned int vao;
@@ -604,29 +736,21 @@ namespace bifrost
 
     Texture LoadTexture(const char* filename)
     {
-        Texture texture = {};
-
-        int texture_width, texture_height, texture_channel_count;
-        stbi_set_flip_vertically_on_load(true);
-        unsigned char* data = stbi_load(filename, &texture_width, &texture_height, &texture_channel_count, 0);
-        glGenTextures(1, &texture.id);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture.id);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture_width, texture_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        stbi_image_free(data);
-
-        texture.width = texture_width;
-        texture.height = texture_height;
-
-        return texture;
+        std::ifstream file(filename, std::ios::binary);
+        std::vector<unsigned char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (contents.empty())
+        {
+            fprintf(stderr, "bifrost: could not read texture %s\n", filename);
+            return {};
+        }
+        return LoadTexture(contents.data(), (int)contents.size());
     }
 
     Texture LoadTexture(const unsigned char* png_data, const int png_size)
     {
+        if (IsBtex(png_data, (size_t)png_size))
+            return LoadBtexTexture(png_data, (size_t)png_size);
+
         Texture texture = {};
 
         int texture_width, texture_height, texture_channel_count;
@@ -648,12 +772,32 @@ namespace bifrost
         return texture;
     }
 
+    void DestroyTexture(Texture& texture)
+    {
+        glDeleteTextures(1, &texture.id);
+        texture = {};
+    }
+
+    void DestroyShader(Shader& shader)
+    {
+        glDeleteProgram(shader.id);
+        shader = {};
+    }
+
+    void DestroyFramebuffer(Framebuffer& framebuffer)
+    {
+        glDeleteFramebuffers(1, &framebuffer.id);
+        glDeleteTextures(1, &framebuffer.texture_id);
+        framebuffer = {};
+    }
+
     Camera2d GenOrthogonalCamera2d(const glm::vec2 min, const glm::vec2 max)
     {
         Camera2d camera = {};
 
         camera.projection = glm::ortho(min.x, max.x, min.y, max.y, -1.0f, 1.0f);
         camera.dimensions = glm::vec2(max.x - min.x, max.y - min.y);
+        camera.view = GetViewBounds(camera);
 
         return camera;
     }
@@ -671,6 +815,88 @@ namespace bifrost
         return glm::ivec2{width, height};
     }
 
+    Aabb GetViewBounds(const Camera2d& camera)
+    {
+        glm::mat4 inverse = glm::inverse(camera.projection);
+        const glm::vec2 corners[] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+
+        Aabb bounds = {glm::vec2(std::numeric_limits<float>::max()), glm::vec2(std::numeric_limits<float>::lowest())};
+        for (const auto& corner : corners)
+        {
+            glm::vec2 p = glm::vec2(inverse * glm::vec4(corner, 0.0f, 1.0f));
+            bounds.min = glm::min(bounds.min, p);
+            bounds.max = glm::max(bounds.max, p);
+        }
+        return bounds;
+    }
+
+    bool IsVisible(const Camera2d& camera, Aabb bounds)
+    {
+        return bounds.max.x >= camera.view.min.x && bounds.min.x <= camera.view.max.x &&
+               bounds.max.y >= camera.view.min.y && bounds.min.y <= camera.view.max.y;
+    }
+
+    Aabb GetRectangleBounds(glm::vec2 origin, glm::vec2 size, float angle)
+    {
+        glm::vec2 half = glm::abs(size) * 0.5f;
+        if (angle != 0.0f)
+        {
+            float c = std::abs(std::cos(glm::radians(angle)));
+            float s = std::abs(std::sin(glm::radians(angle)));
+            half = glm::vec2(c * half.x + s * half.y, s * half.x + c * half.y);
+        }
+        return {origin - half, origin + half};
+    }
+
+    void CullSprites(const Camera2d& camera, std::span<const glm::vec2> centers, std::span<const glm::vec2> sizes, std::vector<uint32_t>& visible)
+    {
+        visible.clear();
+        size_t count = std::min(centers.size(), sizes.size());
+        const float* center = &centers.data()->x;
+        const float* size = &sizes.data()->x;
+
+        // Overlap on an axis is |2 * center - (view.min + view.max)| <= |size| + view width.
+        glm::vec2 view_center = camera.view.min + camera.view.max;
+        glm::vec2 view_size = camera.view.max - camera.view.min;
+
+        size_t i = 0;
+#ifdef BIFROST_SSE2
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        const __m128 view_center_x = _mm_set1_ps(view_center.x);
+        const __m128 view_center_y = _mm_set1_ps(view_center.y);
+        const __m128 view_size_x = _mm_set1_ps(view_size.x);
+        const __m128 view_size_y = _mm_set1_ps(view_size.y);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            // Two loads hold four interleaved vec2s; the shuffles split them into x and y.
+            __m128 center_01 = _mm_loadu_ps(center + i * 2);
+            __m128 center_23 = _mm_loadu_ps(center + i * 2 + 4);
+            __m128 size_01 = _mm_loadu_ps(size + i * 2);
+            __m128 size_23 = _mm_loadu_ps(size + i * 2 + 4);
+            __m128 center_x = _mm_shuffle_ps(center_01, center_23, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 center_y = _mm_shuffle_ps(center_01, center_23, _MM_SHUFFLE(3, 1, 3, 1));
+            __m128 size_x = _mm_andnot_ps(sign, _mm_shuffle_ps(size_01, size_23, _MM_SHUFFLE(2, 0, 2, 0)));
+            __m128 size_y = _mm_andnot_ps(sign, _mm_shuffle_ps(size_01, size_23, _MM_SHUFFLE(3, 1, 3, 1)));
+
+            __m128 distance_x = _mm_andnot_ps(sign, _mm_sub_ps(_mm_add_ps(center_x, center_x), view_center_x));
+            __m128 distance_y = _mm_andnot_ps(sign, _mm_sub_ps(_mm_add_ps(center_y, center_y), view_center_y));
+            __m128 inside = _mm_and_ps(_mm_cmple_ps(distance_x, _mm_add_ps(size_x, view_size_x)),
+                                       _mm_cmple_ps(distance_y, _mm_add_ps(size_y, view_size_y)));
+
+            for (unsigned int mask = (unsigned int)_mm_movemask_ps(inside); mask; mask &= mask - 1)
+                visible.push_back((uint32_t)(i + std::countr_zero(mask)));
+        }
+#endif
+
+        for (; i < count; i++)
+        {
+            if (std::abs(2.0f * center[i * 2] - view_center.x) <= std::abs(size[i * 2]) + view_size.x &&
+                std::abs(2.0f * center[i * 2 + 1] - view_center.y) <= std::abs(size[i * 2 + 1]) + view_size.y)
+                visible.push_back((uint32_t)i);
+        }
+    }
+
     void DrawRectangle(bifrost::Camera2d camera, glm::vec2 origin, glm::vec2 size, glm::vec3 color)
     {
         DrawRectangle(camera, origin, size, 0.0f, glm::vec4(color, 1.0f));
@@ -688,6 +914,8 @@ namespace bifrost
 
     void DrawRectangle(bifrost::Camera2d camera, glm::vec2 origin, glm::vec2 size, float angle, glm::vec4 color)
     {
+        if (!IsVisible(camera, GetRectangleBounds(origin, size, angle)))
+            return;
         InitializeDrawing();
         auto model = glm::translate(glm::mat4(1.0f), glm::vec3(origin.x, origin.y, 0.0f));
         model = glm::rotate(model, glm::radians(angle), glm::vec3(0.0f, 0.0f, -1.0f));
@@ -764,6 +992,8 @@ namespace bifrost
 
     void DrawRectangle(bifrost::Camera2d camera, glm::vec2 origin, glm::vec2 size, float angle, bifrost::Texture texture, glm::vec4 color)
     {
+        if (!IsVisible(camera, GetRectangleBounds(origin, size, angle)))
+            return;
         InitializeDrawing();
         auto model = glm::translate(glm::mat4(1.0f), glm::vec3(origin.x, origin.y, 0.0f));
         model = glm::rotate(model, glm::radians(angle), glm::vec3(0.0f, 0.0f, -1.0f));
@@ -809,6 +1039,8 @@ namespace bifrost
 
     void DrawRectangle(bifrost::Camera2d camera, glm::vec2 origin, glm::vec2 size, float angle, bifrost::Texture texture, glm::vec2 source_origin, glm::vec2 source_size, glm::vec4 color)
     {
+        if (!IsVisible(camera, GetRectangleBounds(origin, size, angle)))
+            return;
         InitializeDrawing();
         glm::vec2 uv_start = glm::vec2(source_origin.x / (float)texture.width, source_origin.y / (float)texture.height);
         glm::vec2 uv_end = uv_start + glm::vec2(source_size.x / (float)texture.width, source_size.y / (float)texture.height);
@@ -839,7 +1071,53 @@ namespace bifrost
         glUniformMatrix4fv(glGetUniformLocation(uv_texture_shader.id, "mvp"), 1, GL_FALSE, glm::value_ptr(camera.projection * model));
         glUniform4fv(glGetUniformLocation(uv_texture_shader.id, "color"), 1, glm::value_ptr(color));
         glDrawArrays(GL_TRIANGLES, 0, 6);
-        
+
+        glBindVertexArray(0);
+    }
+
+    void DrawRectangleInstanced(Camera2d camera, glm::vec2 origin, glm::vec2 size, Texture texture, glm::vec2 source_origin, glm::vec2 source_size, std::span<const glm::vec2> offsets, std::span<const uint32_t> colors)
+    {
+        InitializeDrawing();
+        if (texture.id == 0)
+        {
+            texture = white_texture;
+            source_origin = glm::vec2(0.0f);
+            source_size = glm::vec2(1.0f);
+        }
+        SetQuadUvs(texture, source_origin, source_size);
+
+        glBindBuffer(GL_ARRAY_BUFFER, offset_vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2) * offsets.size(), offsets.data(), GL_STREAM_DRAW);
+
+        glBindBuffer(GL_ARRAY_BUFFER, color_vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(uint32_t) * colors.size(), colors.data(), GL_STREAM_DRAW);
+
+        auto model = glm::translate(glm::mat4(1.0f), glm::vec3(origin.x, origin.y, 0.0f));
+        model = glm::scale(model, glm::vec3(size.x, size.y, 1.0f));
+
+        glDisable(GL_DEPTH_TEST);
+        glBindVertexArray(uv_quad_vao);
+
+        glEnableVertexAttribArray(2);
+        glBindBuffer(GL_ARRAY_BUFFER, offset_vbo);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glVertexAttribDivisor(2, 1);
+
+        glDisableVertexAttribArray(3);
+
+        glEnableVertexAttribArray(4);
+        glBindBuffer(GL_ARRAY_BUFFER, color_vbo);
+        glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(uint32_t), (void*)0);
+        glVertexAttribDivisor(4, 1);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture.id);
+
+        glUseProgram(instanced_color_texture_shader.id);
+        glUniformMatrix4fv(glGetUniformLocation(instanced_color_texture_shader.id, "m"), 1, GL_FALSE, glm::value_ptr(model));
+        glUniformMatrix4fv(glGetUniformLocation(instanced_color_texture_shader.id, "vp"), 1, GL_FALSE, glm::value_ptr(camera.projection));
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (int)std::min(offsets.size(), colors.size()));
+
         glBindVertexArray(0);
     }
 
@@ -886,12 +1164,16 @@ namespace bifrost
 
 	    glm::vec2 offset = glm::vec2(0.0f);
 
-	    std::vector<glm::vec2> offsets{};
-	    std::vector<glm::vec2> uvs{};
-
 	    glEnable(GL_BLEND);
 	    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+	    auto& arena = GetFrameArena();
+	    FrameArena::Scope scope(arena);
+	    ArenaVector<glm::vec2> offsets(&arena);
+	    ArenaVector<glm::vec2> uvs(&arena);
+	    offsets.reserve(str.size());
+	    uvs.reserve(str.size());
+
 	    for(auto& c : str)
 	    {
 		    if (c == '\n')
@@ -903,42 +1185,7 @@ namespace bifrost
 		    int index = int(c) - 32;
 		    int x = index % 16;
 		    int y = index / 16;
-		    float char_width = 6.0f;
-		    switch (c)
-		    {
-			    case '!':
-			    case '\'':
-			    case ',':
-			    case '.':
-			    case ':':
-			    case ';':
-			    case 'i':
-			    case 'j':
-			    case '|':
-				    char_width = 2.0f;
-				    break;
-			    case 'l':
-				    char_width = 3.0f;
-				    break;
-			    case '"':
-			    case '(':
-			    case ')':
-			    case '?':
-			    case 'I':
-			    case '^':
-			    case '{':
-			    case '}':
-				    char_width = 4.0f;
-				    break;
-			    case '/':
-			    case '<':
-			    case '>':
-			    case '[':
-			    case '\\':
-			    case ']':
-				    char_width = 5.0f;
-				    break;
-		    }
+		    float char_width = GetDebugCharWidth(c);
 
 		    if (text_wrap_width > 0.0f && (offset.x + height / 12.0f * char_width) > text_wrap_width)
 		    {
@@ -965,6 +1212,54 @@ namespace bifrost
 	    return origin + offset;
     }
 
+    Texture GetDebugFontTexture()
+    {
+        InitializeDrawing();
+        return debug_font_texture;
+    }
+
+    Texture GetWhiteTexture()
+    {
+        InitializeDrawing();
+        return white_texture;
+    }
+
+    float GetDebugCharWidth(char c)
+    {
+        switch (c)
+        {
+        case '!':
+        case '\'':
+        case ',':
+        case '.':
+        case ':':
+        case ';':
+        case 'i':
+        case 'j':
+        case '|':
+            return 2.0f;
+        case 'l':
+            return 3.0f;
+        case '"':
+        case '(':
+        case ')':
+        case '?':
+        case 'I':
+        case '^':
+        case '{':
+        case '}':
+            return 4.0f;
+        case '/':
+        case '<':
+        case '>':
+        case '[':
+        case '\\':
+        case ']':
+            return 5.0f;
+        }
+        return 6.0f;
+    }
+
     void EnableTextWrap(float width)
     {
         text_wrap_width = width;
@@ -3,7 +3,10 @@
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 #include <cstdint>
+#include <limits>
+#include <span>
 #include <string>
+#include <vector>
 
 #include <glm/glm.hpp>
 #include <glm/ext/matrix_clip_space.hpp>
@@ -35,12 +38,26 @@ namespace bifrost
         unsigned int id;
         unsigned int width;
         unsigned int height;        
+        // Color already multiplied by alpha, from a .btex cooked with --premultiply. The
+        // draw calls blend straight alpha, so draw these with
+        // glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA) set.
+        bool premultiplied = false;
+    };
+
+    // Axis-aligned box in world units.
+    struct Aabb
+    {
+        glm::vec2 min;
+        glm::vec2 max;
     };
 
     struct Camera2d
     {
         glm::mat4 projection;
         glm::vec2 dimensions;
+        // World-space bounds of what projection shows, filled in by the Gen functions. A
+        // camera built by hand keeps the unbounded default, so nothing is culled.
+        Aabb view{glm::vec2(std::numeric_limits<float>::lowest()), glm::vec2(std::numeric_limits<float>::max())};
     };
 
     /*************
@@ -54,14 +71,32 @@ namespace bifrost
     Shader GenShaderFromSource(const char* vert_shader_code, const char* frag_shader_code);
     Shader GenShader(const char* vert_shader_file, const char* geom_shader_file, const char* frag_shader_file);
     Shader GenShaderFromSource(const char* vert_shader_code, const char* geom_shader_code, const char* frag_shader_code);
+    // Logs the info log and returns a zero shader if it doesn't link.
+    Shader GenComputeShaderFromSource(const char* compute_shader_code);
     unsigned int GenVec4Vao(const float vertices[], const unsigned int count);
     unsigned int GenVec2Vao(const float vertices[], const unsigned int count);
+    // The file and in-memory loaders take any image stb_image reads, or a .btex from
+    // tools/cooktex.cpp, which is uploaded without decoding.
     Texture LoadTexture(const char* filename);
     Texture LoadTexture(const unsigned char* data, const int texture_width, const int texture_height);
     Texture LoadTexture(const unsigned char* png_data, const int png_size);
     Camera2d GenOrthogonalCamera2d(const glm::vec2 origin, const glm::vec2 dimensions);
     Camera2d GenUICamera(const int width, const int height);
     glm::ivec2 GetScreenSize(GLFWwindow& window);
+    // The Gen functions fill in camera.view from this; call it again after changing a
+    // camera's projection by hand to turn culling on.
+    Aabb GetViewBounds(const Camera2d& camera);
+    bool IsVisible(const Camera2d& camera, Aabb bounds);
+    // Bounds of a size rectangle centered on origin and rotated clockwise by angle degrees.
+    Aabb GetRectangleBounds(glm::vec2 origin, glm::vec2 size, float angle = 0.0f);
+    // Replaces visible with the indices of the rectangles, centered on centers[i] and
+    // sizes[i] across, that overlap camera.view. Tests four at a time with SSE2.
+    void CullSprites(const Camera2d& camera, std::span<const glm::vec2> centers, std::span<const glm::vec2> sizes, std::vector<uint32_t>& visible);
+    // Delete the GL objects right away and zero the ids. The GPU may still be using them;
+    // ResourceRegistry defers this until it's done.
+    void DestroyTexture(Texture& texture);
+    void DestroyShader(Shader& shader);
+    void DestroyFramebuffer(Framebuffer& framebuffer);
 
     /*************
      * 
@@ -90,6 +125,10 @@ namespace bifrost
     void DrawRectangle(bifrost::Camera2d camera, glm::vec2 origin, glm::vec2 size, float angle, bifrost::Texture texture, glm::vec2 source_origin, glm::vec2 source_size, glm::vec3 color);
     void DrawRectangle(bifrost::Camera2d camera, glm::vec2 origin, glm::vec2 size, float angle, bifrost::Texture texture, glm::vec2 source_origin, glm::vec2 source_size, glm::vec4 color);
 
+    // Instanced: one draw call for many copies of a quad, each centered at origin + offsets[i]
+    // and tinted by colors[i] (RGBA8, red in the low byte). A zero texture draws solid quads.
+    void DrawRectangleInstanced(Camera2d camera, glm::vec2 origin, glm::vec2 size, Texture texture, glm::vec2 source_origin, glm::vec2 source_size, std::span<const glm::vec2> offsets, std::span<const uint32_t> colors);
+
     // Text
     glm::vec2 DrawDebugText(Camera2d camera, glm::vec2 origin, float height, const char* format, ...);
     glm::vec2 DrawDebugText(Camera2d camera, glm::vec2 origin, float height, glm::vec3 color, const char* format, ...);
@@ -99,6 +138,12 @@ namespace bifrost
     glm::vec2 DrawDebugText(Camera2d camera, glm::vec2 origin, float height, glm::vec4 color, std::string_view str);
     void EnableTextWrap(float width);
     void DisableTextWrap();
+    // The debug font is a 16x6 grid of 7x12 glyphs starting at ' '; the char width is the
+    // advance in font pixels, for code that lays out debug text itself.
+    Texture GetDebugFontTexture();
+    float GetDebugCharWidth(char c);
+    // A 1x1 opaque white texture, for untextured quads in batches that always sample.
+    Texture GetWhiteTexture();
 
     // Lines
     void DrawLine(bifrost::Camera2d camera, glm::vec2 begin, glm::vec2 end, float width, glm::vec3 color);
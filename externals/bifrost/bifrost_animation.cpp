@@ -0,0 +1,199 @@
+#include "bifrost_animation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+
+constexpr uint32_t NO_ROW = 0xFFFFFFFF;
+
+uint32_t PackColor(glm::vec4 color)
+{
+    glm::uvec4 c = glm::uvec4(glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f);
+    return c.r | (c.g << 8) | (c.b << 16) | (c.a << 24);
+}
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+Animator::Animator(Texture atlas)
+    : atlas_(atlas)
+{
+}
+
+ClipId Animator::AddClip(std::span<const AtlasRegion> frames, float fps, AnimationMode mode)
+{
+    glm::vec2 texture_size = glm::vec2((float)atlas_.width, (float)atlas_.height);
+    if (frames.empty() || fps <= 0.0f)
+    {
+        fprintf(stderr, "bifrost: animation clip needs at least one frame and a positive fps\n");
+        AtlasRegion whole{glm::vec2(0.0f), texture_size};
+        return AddClip(std::span(&whole, 1), 1.0f, mode);
+    }
+
+    Clip clip{(uint32_t)frame_uvs_.size(), (uint32_t)frames.size(), fps, (float)frames.size() / fps, mode};
+    for (const AtlasRegion& frame : frames)
+    {
+        glm::vec2 uv_start = frame.origin / texture_size;
+        glm::vec2 uv_end = uv_start + frame.size / texture_size;
+        frame_uvs_.push_back(glm::vec4(uv_start, uv_end));
+    }
+    clip_data_.push_back(clip);
+    return (ClipId)(clip_data_.size() - 1);
+}
+
+ClipId Animator::AddClip(const Tileset& tileset, std::span<const uint16_t> tiles, float fps, AnimationMode mode)
+{
+    std::vector<AtlasRegion> frames{};
+    frames.reserve(tiles.size());
+    for (uint16_t tile : tiles)
+    {
+        glm::vec2 cell = glm::vec2((float)(tile % tileset.columns), (float)(tile / tileset.columns));
+        frames.push_back(AtlasRegion{cell * tileset.stride, tileset.tile_size});
+    }
+    return AddClip(frames, fps, mode);
+}
+
+AnimationId Animator::Play(ClipId clip, glm::vec2 position, glm::vec2 size, glm::vec4 color)
+{
+    uint32_t index;
+    if (!free_slots_.empty())
+    {
+        index = free_slots_.back();
+        free_slots_.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)slots_.size();
+        slots_.push_back(Slot{NO_ROW, 1});
+    }
+
+    slots_[index].row = (uint32_t)clips_.size();
+    clips_.push_back(clip);
+    times_.push_back(0.0f);
+    speeds_.push_back(1.0f);
+    positions_.push_back(position);
+    sizes_.push_back(size);
+    colors_.push_back(PackColor(color));
+    uv_rects_.push_back(frame_uvs_[clip_data_[clip].first_frame]);
+    row_slots_.push_back(index);
+    return AnimationId{index, slots_[index].generation};
+}
+
+void Animator::Stop(AnimationId id)
+{
+    uint32_t row = GetRow(id);
+    if (row == NO_ROW)
+        return;
+
+    size_t last = clips_.size() - 1;
+    clips_[row] = clips_[last];
+    times_[row] = times_[last];
+    speeds_[row] = speeds_[last];
+    positions_[row] = positions_[last];
+    sizes_[row] = sizes_[last];
+    colors_[row] = colors_[last];
+    uv_rects_[row] = uv_rects_[last];
+    row_slots_[row] = row_slots_[last];
+    slots_[row_slots_[row]].row = row;
+
+    clips_.pop_back();
+    times_.pop_back();
+    speeds_.pop_back();
+    positions_.pop_back();
+    sizes_.pop_back();
+    colors_.pop_back();
+    uv_rects_.pop_back();
+    row_slots_.pop_back();
+
+    slots_[id.index].row = NO_ROW;
+    slots_[id.index].generation++;
+    free_slots_.push_back(id.index);
+}
+
+void Animator::SetClip(AnimationId id, ClipId clip)
+{
+    uint32_t row = GetRow(id);
+    if (row == NO_ROW || clips_[row] == clip)
+        return;
+    clips_[row] = clip;
+    times_[row] = 0.0f;
+    uv_rects_[row] = frame_uvs_[clip_data_[clip].first_frame];
+}
+
+void Animator::SetPosition(AnimationId id, glm::vec2 position)
+{
+    uint32_t row = GetRow(id);
+    if (row != NO_ROW)
+        positions_[row] = position;
+}
+
+void Animator::SetSpeed(AnimationId id, float speed)
+{
+    uint32_t row = GetRow(id);
+    if (row != NO_ROW)
+        speeds_[row] = std::max(speed, 0.0f);
+}
+
+void Animator::SetColor(AnimationId id, glm::vec4 color)
+{
+    uint32_t row = GetRow(id);
+    if (row != NO_ROW)
+        colors_[row] = PackColor(color);
+}
+
+bool Animator::IsFinished(AnimationId id) const
+{
+    uint32_t row = GetRow(id);
+    if (row == NO_ROW)
+        return true;
+    const Clip& clip = clip_data_[clips_[row]];
+    return clip.mode == AnimationMode::Once && times_[row] >= clip.length;
+}
+
+uint32_t Animator::GetRow(AnimationId id) const
+{
+    if (id.index >= slots_.size() || slots_[id.index].generation != id.generation)
+        return NO_ROW;
+    return slots_[id.index].row;
+}
+
+void Animator::Update(float dt)
+{
+    const Clip* clip_data = clip_data_.data();
+    const glm::vec4* frame_uvs = frame_uvs_.data();
+    const ClipId* clips = clips_.data();
+    const float* speeds = speeds_.data();
+    float* times = times_.data();
+    glm::vec4* uv_rects = uv_rects_.data();
+
+    size_t count = clips_.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        const Clip& clip = clip_data[clips[i]];
+        float time = times[i] + dt * speeds[i];
+        if (time >= clip.length)
+            time = clip.mode == AnimationMode::Loop ? std::fmod(time, clip.length) : clip.length;
+        times[i] = time;
+
+        uint32_t frame = std::min((uint32_t)(time * clip.fps), clip.frame_count - 1);
+        uv_rects[i] = frame_uvs[clip.first_frame + frame];
+    }
+}
+
+void Animator::Draw(RenderQueue& queue, int layer) const
+{
+    queue.DrawSprites(layer, atlas_, positions_, sizes_, uv_rects_, colors_);
+}
+
+void Animator::Draw(RenderQueue& queue, int layer, const Camera2d& camera)
+{
+    CullSprites(camera, positions_, sizes_, visible_);
+    queue.DrawSprites(layer, atlas_, positions_, sizes_, uv_rects_, colors_, visible_);
+}
+
+} // namespace bifrost
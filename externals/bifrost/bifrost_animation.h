@@ -0,0 +1,107 @@
+#pragma once
+
+#include "bifrost.h"
+#include "bifrost_render.h"
+#include "bifrost_tilemap.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace bifrost
+{
+    // A rectangle of an atlas in pixels, same coordinates as DrawRectangle's source_origin
+    // and source_size.
+    struct AtlasRegion
+    {
+        glm::vec2 origin;
+        glm::vec2 size;
+    };
+
+    enum class AnimationMode
+    {
+        Loop,
+        Once,   // holds the last frame and reports IsFinished()
+    };
+
+    using ClipId = uint32_t;
+
+    // Goes stale once the animation is stopped, and stays stale when its slot is reused;
+    // calls with a stale id do nothing.
+    struct AnimationId
+    {
+        uint32_t index;
+        uint32_t generation;
+
+        bool operator==(const AnimationId&) const = default;
+    };
+
+    // Flipbook animation over one atlas. A clip is a run of atlas regions shown at a fixed
+    // rate; every playing instance of a clip is a row in flat arrays (clip, time, speed,
+    // position, size, color, current uv rect), so Update() is one loop over all of them and
+    // Draw() hands those arrays to RenderQueue::DrawSprites as they are. Nothing is
+    // allocated per instance once the arrays have grown to the largest count played.
+    class Animator
+    {
+    public:
+        explicit Animator(Texture atlas);
+
+        ClipId AddClip(std::span<const AtlasRegion> frames, float fps, AnimationMode mode = AnimationMode::Loop);
+        // Frames from tile indices of a tileset over the same atlas, e.g. a row of a sheet.
+        ClipId AddClip(const Tileset& tileset, std::span<const uint16_t> tiles, float fps, AnimationMode mode = AnimationMode::Loop);
+
+        AnimationId Play(ClipId clip, glm::vec2 position, glm::vec2 size, glm::vec4 color = glm::vec4(1.0f));
+        void Stop(AnimationId id);
+        // Restarts from the first frame, unless clip is already the one playing.
+        void SetClip(AnimationId id, ClipId clip);
+        void SetPosition(AnimationId id, glm::vec2 position);
+        // Multiplies the clip's rate; 0 pauses.
+        void SetSpeed(AnimationId id, float speed);
+        void SetColor(AnimationId id, glm::vec4 color);
+        // True for a stale id as well.
+        bool IsFinished(AnimationId id) const;
+        size_t Size() const { return clips_.size(); }
+
+        void Update(float dt);
+        void Draw(RenderQueue& queue, int layer) const;
+        // Records only the instances inside camera.view.
+        void Draw(RenderQueue& queue, int layer, const Camera2d& camera);
+
+    private:
+        struct Clip
+        {
+            uint32_t first_frame;
+            uint32_t frame_count;
+            float fps;
+            float length;       // seconds
+            AnimationMode mode;
+        };
+
+        struct Slot
+        {
+            uint32_t row;           // NO_ROW once stopped
+            uint32_t generation;
+        };
+
+        // The row of a live id, or NO_ROW.
+        uint32_t GetRow(AnimationId id) const;
+
+        Texture atlas_;
+        std::vector<Clip> clip_data_{};
+        std::vector<glm::vec4> frame_uvs_{};    // every clip's frames, back to back
+
+        // One row per playing instance, packed; Stop() moves the last row into the gap.
+        std::vector<ClipId> clips_{};
+        std::vector<float> times_{};
+        std::vector<float> speeds_{};
+        std::vector<glm::vec2> positions_{};
+        std::vector<glm::vec2> sizes_{};
+        std::vector<uint32_t> colors_{};
+        std::vector<glm::vec4> uv_rects_{};
+        std::vector<uint32_t> row_slots_{};     // slot of each row
+
+        std::vector<Slot> slots_{};
+        std::vector<uint32_t> free_slots_{};
+        std::vector<uint32_t> visible_{};
+    };
+}
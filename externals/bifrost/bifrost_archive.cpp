@@ -0,0 +1,454 @@
+#include "bifrost_archive.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+// LZ4 block format limits: matches are at least 4 bytes, the last match starts at least
+// 12 bytes before the end and the last 5 bytes are always literals.
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MATCH_START_LIMIT = 12;
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 16;
+
+uint32_t Read32(const unsigned char* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t HashSequence(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Writes the 15 + 255 + 255 + ... + remainder tail of a length that didn't fit its nibble.
+void WriteLength(unsigned char* out, size_t& op, size_t length)
+{
+    length -= 15;
+    while (length >= 255)
+    {
+        out[op++] = 255;
+        length -= 255;
+    }
+    out[op++] = (unsigned char)length;
+}
+
+bool ReadLength(std::span<const unsigned char> src, size_t& ip, size_t& length)
+{
+    unsigned char byte;
+    do
+    {
+        if (ip >= src.size())
+            return false;
+        byte = src[ip++];
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+void WriteSequence(unsigned char* out, size_t& op, const unsigned char* literals, size_t literal_length, size_t offset, size_t match_length)
+{
+    size_t token = op++;
+    size_t match_code = match_length ? match_length - MIN_MATCH : 0;
+    out[token] = (unsigned char)((std::min<size_t>(literal_length, 15) << 4) | std::min<size_t>(match_code, 15));
+
+    if (literal_length >= 15)
+        WriteLength(out, op, literal_length);
+    // An empty input has a null literals pointer, which memcpy may not take even for 0 bytes.
+    if (literal_length > 0)
+        memcpy(out + op, literals, literal_length);
+    op += literal_length;
+
+    if (match_length == 0)
+        return;
+    out[op++] = (unsigned char)(offset & 0xff);
+    out[op++] = (unsigned char)(offset >> 8);
+    if (match_code >= 15)
+        WriteLength(out, op, match_code);
+}
+
+size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+uint64_t HashArchiveName(std::string_view name)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : name)
+    {
+        hash ^= (unsigned char)c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+size_t Lz4CompressBound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+size_t Lz4Compress(std::span<const unsigned char> src, std::span<unsigned char> dst)
+{
+    const unsigned char* in = src.data();
+    unsigned char* out = dst.data();
+    size_t size = src.size();
+    size_t op = 0;
+    size_t anchor = 0;
+
+    if (size > MATCH_START_LIMIT)
+    {
+        std::vector<uint32_t> table((size_t)1 << HASH_BITS, 0);
+        size_t match_limit = size - LAST_LITERALS;
+        size_t ip = 0;
+        while (ip < size - MATCH_START_LIMIT)
+        {
+            uint32_t sequence = Read32(in + ip);
+            uint32_t& slot = table[HashSequence(sequence)];
+            size_t candidate = slot;
+            slot = (uint32_t)ip;
+
+            if (candidate < ip && ip - candidate <= MAX_OFFSET && Read32(in + candidate) == sequence)
+            {
+                size_t length = MIN_MATCH;
+                while (ip + length < match_limit && in[candidate + length] == in[ip + length])
+                    length++;
+
+                WriteSequence(out, op, in + anchor, ip - anchor, ip - candidate, length);
+                ip += length;
+                anchor = ip;
+                continue;
+            }
+
+            // Step further the longer nothing matched, so incompressible data goes fast.
+            ip += 1 + ((ip - anchor) >> 6);
+        }
+    }
+
+    WriteSequence(out, op, in + anchor, size - anchor, 0, 0);
+    return op;
+}
+
+bool Lz4Decompress(std::span<const unsigned char> src, std::span<unsigned char> dst)
+{
+    size_t ip = 0;
+    size_t op = 0;
+    while (ip < src.size())
+    {
+        unsigned char token = src[ip++];
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !ReadLength(src, ip, literal_length))
+            return false;
+        if (literal_length > src.size() - ip || literal_length > dst.size() - op)
+            return false;
+        if (literal_length > 0)
+            memcpy(dst.data() + op, src.data() + ip, literal_length);
+        ip += literal_length;
+        op += literal_length;
+
+        // The last sequence has no match.
+        if (ip == src.size())
+            break;
+
+        if (src.size() - ip < 2)
+            return false;
+        size_t offset = src[ip] | ((size_t)src[ip + 1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op)
+            return false;
+
+        size_t match_length = token & 15;
+        if (match_length == 15 && !ReadLength(src, ip, match_length))
+            return false;
+        match_length += MIN_MATCH;
+        if (match_length > dst.size() - op)
+            return false;
+
+        unsigned char* match = dst.data() + op - offset;
+        if (offset >= match_length)
+        {
+            memcpy(dst.data() + op, match, match_length);
+        }
+        else
+        {
+            // Overlapping copies repeat the last offset bytes.
+            for (size_t i = 0; i < match_length; i++)
+                dst[op + i] = match[i];
+        }
+        op += match_length;
+    }
+    return op == dst.size();
+}
+
+AssetArchive::~AssetArchive()
+{
+    Close();
+}
+
+bool AssetArchive::Open(const char* path)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        fprintf(stderr, "bifrost: could not open archive %s\n", path);
+        return false;
+    }
+    LARGE_INTEGER file_size{};
+    GetFileSizeEx(file, &file_size);
+    HANDLE mapping = file_size.QuadPart > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    CloseHandle(file);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        fprintf(stderr, "bifrost: could not map archive %s\n", path);
+        return false;
+    }
+    mapping_ = mapping;
+    data_ = static_cast<const unsigned char*>(view);
+    size_ = (size_t)file_size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "bifrost: could not open archive %s\n", path);
+        return false;
+    }
+    struct stat info{};
+    void* view = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+        view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+    {
+        fprintf(stderr, "bifrost: could not map archive %s\n", path);
+        return false;
+    }
+    data_ = static_cast<const unsigned char*>(view);
+    size_ = (size_t)info.st_size;
+#endif
+
+    if (!Validate(path))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void AssetArchive::Close()
+{
+    if (data_)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+        CloseHandle(mapping_);
+#else
+        munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+    mapping_ = nullptr;
+    entries_.clear();
+    hashes_.clear();
+    offsets_.clear();
+}
+
+bool AssetArchive::Validate(const char* path)
+{
+    ArchiveHeader header{};
+    if (size_ < sizeof(header))
+    {
+        fprintf(stderr, "bifrost: %s is too small to be an archive\n", path);
+        return false;
+    }
+    memcpy(&header, data_, sizeof(header));
+
+    if (header.magic != ARCHIVE_MAGIC || header.version != ARCHIVE_VERSION)
+    {
+        fprintf(stderr, "bifrost: %s is not a version %u archive\n", path, ARCHIVE_VERSION);
+        return false;
+    }
+
+    size_t entries_size = (size_t)header.entry_count * sizeof(ArchiveTocEntry);
+    if (header.toc_offset > size_ || header.toc_size > size_ - header.toc_offset || entries_size > header.toc_size)
+    {
+        fprintf(stderr, "bifrost: %s has a truncated table of contents\n", path);
+        return false;
+    }
+
+    const unsigned char* toc = data_ + header.toc_offset;
+    const char* names = reinterpret_cast<const char*>(toc + entries_size);
+    size_t names_size = header.toc_size - entries_size;
+
+    entries_.reserve(header.entry_count);
+    hashes_.reserve(header.entry_count);
+    offsets_.reserve(header.entry_count);
+    for (uint32_t i = 0; i < header.entry_count; i++)
+    {
+        ArchiveTocEntry entry{};
+        memcpy(&entry, toc + i * sizeof(ArchiveTocEntry), sizeof(entry));
+
+        bool valid = entry.offset <= header.toc_offset && entry.stored_size <= header.toc_offset - entry.offset
+                  && entry.name_offset <= names_size && entry.name_length <= names_size - entry.name_offset
+                  && (entry.codec == (uint32_t)ArchiveCodec::Lz4
+                      || (entry.codec == (uint32_t)ArchiveCodec::None && entry.stored_size == entry.size))
+                  && (hashes_.empty() || hashes_.back() <= entry.name_hash);
+        if (!valid)
+        {
+            fprintf(stderr, "bifrost: %s has a corrupt entry %u\n", path, i);
+            return false;
+        }
+
+        entries_.push_back({std::string_view(names + entry.name_offset, entry.name_length), entry.size, entry.stored_size, (ArchiveCodec)entry.codec});
+        hashes_.push_back(entry.name_hash);
+        offsets_.push_back(entry.offset);
+    }
+    return true;
+}
+
+const ArchiveEntry* AssetArchive::Find(std::string_view name) const
+{
+    uint64_t hash = HashArchiveName(name);
+    auto it = std::lower_bound(hashes_.begin(), hashes_.end(), hash);
+    for (; it != hashes_.end() && *it == hash; it++)
+    {
+        const ArchiveEntry& entry = entries_[it - hashes_.begin()];
+        if (entry.name == name)
+            return &entry;
+    }
+    return nullptr;
+}
+
+std::span<const unsigned char> AssetArchive::View(std::string_view name) const
+{
+    const ArchiveEntry* entry = Find(name);
+    if (!entry || entry->codec != ArchiveCodec::None)
+        return {};
+    return {data_ + offsets_[entry - entries_.data()], (size_t)entry->size};
+}
+
+std::span<const unsigned char> AssetArchive::Load(std::string_view name, std::vector<unsigned char>& scratch) const
+{
+    const ArchiveEntry* entry = Find(name);
+    if (!entry)
+        return {};
+
+    std::span<const unsigned char> stored{data_ + offsets_[entry - entries_.data()], (size_t)entry->stored_size};
+    if (entry->codec == ArchiveCodec::None)
+        return stored;
+
+    scratch.resize((size_t)entry->size);
+    if (!Lz4Decompress(stored, scratch))
+    {
+        fprintf(stderr, "bifrost: archive entry %.*s failed to decompress\n", (int)name.size(), name.data());
+        return {};
+    }
+    return scratch;
+}
+
+void ArchiveWriter::Add(std::string name, std::vector<unsigned char> data, bool compress)
+{
+    uint64_t size = data.size();
+    if (compress && !data.empty())
+    {
+        std::vector<unsigned char> compressed(Lz4CompressBound(data.size()));
+        compressed.resize(Lz4Compress(data, compressed));
+        if (compressed.size() <= data.size() - data.size() / 8)
+        {
+            entries_.push_back({std::move(name), std::move(compressed), size, ArchiveCodec::Lz4});
+            return;
+        }
+    }
+    entries_.push_back({std::move(name), std::move(data), size, ArchiveCodec::None});
+}
+
+bool ArchiveWriter::Write(const char* path, uint32_t alignment) const
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+        return false;
+
+    std::vector<const Pending*> sorted{};
+    for (auto& entry : entries_)
+        sorted.push_back(&entry);
+    std::sort(sorted.begin(), sorted.end(), [](const Pending* a, const Pending* b)
+    {
+        uint64_t hash_a = HashArchiveName(a->name);
+        uint64_t hash_b = HashArchiveName(b->name);
+        return hash_a != hash_b ? hash_a < hash_b : a->name < b->name;
+    });
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    std::vector<ArchiveTocEntry> toc{};
+    std::string names{};
+    const unsigned char padding[4096] = {};
+    size_t position = 0;
+
+    auto pad_to = [&](size_t target)
+    {
+        while (position < target)
+        {
+            size_t count = std::min(target - position, sizeof(padding));
+            fwrite(padding, 1, count, file);
+            position += count;
+        }
+    };
+
+    // Header placeholder, filled in once the table of contents is placed.
+    pad_to(sizeof(ArchiveHeader));
+    for (const Pending* entry : sorted)
+    {
+        pad_to(AlignUp(position, alignment));
+        toc.push_back({HashArchiveName(entry->name), position, entry->data.size(), entry->size, (uint32_t)entry->codec,
+                       (uint32_t)names.size(), (uint32_t)entry->name.size(), 0});
+        names += entry->name;
+        if (!entry->data.empty())
+            fwrite(entry->data.data(), 1, entry->data.size(), file);
+        position += entry->data.size();
+    }
+
+    pad_to(AlignUp(position, alignof(ArchiveTocEntry)));
+    ArchiveHeader header{ARCHIVE_MAGIC, ARCHIVE_VERSION, (uint32_t)toc.size(), alignment, position,
+                         toc.size() * sizeof(ArchiveTocEntry) + names.size()};
+    fwrite(toc.data(), sizeof(ArchiveTocEntry), toc.size(), file);
+    fwrite(names.data(), 1, names.size(), file);
+
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file);
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+} // namespace bifrost
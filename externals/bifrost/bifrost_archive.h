@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bifrost
+{
+    // Archive layout, all little endian:
+    //   ArchiveHeader
+    //   entry data, each entry starting on a multiple of the archive's alignment
+    //   table of contents: entry_count ArchiveTocEntry sorted by name_hash, then the names
+    static constexpr uint32_t ARCHIVE_MAGIC = 0x4b415042; // "BPAK"
+    static constexpr uint32_t ARCHIVE_VERSION = 1;
+
+    enum class ArchiveCodec : uint32_t
+    {
+        None = 0,
+        Lz4 = 1,    // one LZ4 block
+    };
+
+    struct ArchiveHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entry_count;
+        uint32_t alignment;
+        uint64_t toc_offset;
+        uint64_t toc_size;
+    };
+
+    struct ArchiveTocEntry
+    {
+        uint64_t name_hash;     // FNV-1a of the name
+        uint64_t offset;
+        uint64_t stored_size;
+        uint64_t size;          // after decompression
+        uint32_t codec;
+        uint32_t name_offset;   // into the names that follow the entries
+        uint32_t name_length;
+        uint32_t reserved;
+    };
+
+    uint64_t HashArchiveName(std::string_view name);
+
+    // LZ4 block format, for archive entries.
+    size_t Lz4CompressBound(size_t size);
+    // Returns the compressed size; dst needs Lz4CompressBound(src.size()) bytes.
+    size_t Lz4Compress(std::span<const unsigned char> src, std::span<unsigned char> dst);
+    // Fails on malformed input or when the output isn't exactly dst.size() bytes.
+    bool Lz4Decompress(std::span<const unsigned char> src, std::span<unsigned char> dst);
+
+    struct ArchiveEntry
+    {
+        std::string_view name;
+        uint64_t size;
+        uint64_t stored_size;
+        ArchiveCodec codec;
+    };
+
+    // Read-only view of an archive file mapped into memory. Entries stored without
+    // compression are handed out as spans straight into the mapping, valid until Close(),
+    // so they can go to LoadTexture(const unsigned char*, int) or ma_decoder_init_memory
+    // without a copy.
+    class AssetArchive
+    {
+    public:
+        AssetArchive() = default;
+        ~AssetArchive();
+
+        AssetArchive(const AssetArchive&) = delete;
+        AssetArchive& operator=(const AssetArchive&) = delete;
+
+        // Logs to stderr and returns false if the file can't be mapped or isn't a valid archive.
+        bool Open(const char* path);
+        void Close();
+        bool IsOpen() const { return data_ != nullptr; }
+
+        const ArchiveEntry* Find(std::string_view name) const;
+        std::span<const ArchiveEntry> Entries() const { return entries_; }
+
+        // The entry's bytes in the mapping; empty if it's missing or compressed.
+        std::span<const unsigned char> View(std::string_view name) const;
+        // View() for stored entries; compressed ones are decompressed into scratch, which the
+        // returned span then points into. Empty if missing or corrupt.
+        std::span<const unsigned char> Load(std::string_view name, std::vector<unsigned char>& scratch) const;
+
+    private:
+        bool Validate(const char* path);
+
+        const unsigned char* data_ = nullptr;
+        size_t size_ = 0;
+        void* mapping_ = nullptr; // file mapping handle on Windows
+        std::vector<ArchiveEntry> entries_{};
+        std::vector<uint64_t> hashes_{};
+        std::vector<uint64_t> offsets_{};
+    };
+
+    // Builds an archive file; used by the packer tool.
+    class ArchiveWriter
+    {
+    public:
+        // With compress, the entry is stored as LZ4 if that saves at least an eighth of it.
+        void Add(std::string name, std::vector<unsigned char> data, bool compress);
+        // alignment must be a power of two.
+        bool Write(const char* path, uint32_t alignment = 64) const;
+
+    private:
+        struct Pending
+        {
+            std::string name;
+            std::vector<unsigned char> data;
+            uint64_t size;
+            ArchiveCodec codec;
+        };
+
+        std::vector<Pending> entries_{};
+    };
+}
@@ -0,0 +1,159 @@
+#include "bifrost_arena.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+
+namespace
+{
+
+struct ArenaRegistry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<bifrost::FrameArena>> arenas;
+    std::vector<bifrost::FrameArena*> free;
+};
+
+// Never destroyed, since worker threads of static job systems can exit after static
+// destructors have started running.
+ArenaRegistry& GetRegistry()
+{
+    static auto* registry = new ArenaRegistry();
+    return *registry;
+}
+
+// Hands the thread's arena back for reuse by a later thread when this one exits.
+struct ThreadArena
+{
+    bifrost::FrameArena* arena = nullptr;
+
+    ~ThreadArena()
+    {
+        if (!arena)
+            return;
+        auto& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        registry.free.push_back(arena);
+    }
+};
+
+thread_local ThreadArena thread_arena{};
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+FrameArena::FrameArena(size_t block_size)
+    : block_size_(std::max<size_t>(block_size, 1024))
+{
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+    while (block_ < blocks_.size())
+    {
+        auto& block = blocks_[block_];
+        auto base = reinterpret_cast<uintptr_t>(block.memory.get());
+        size_t start = ((base + offset_ + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+        if (start + size <= block.size)
+        {
+            offset_ = start + size;
+            high_water_ = std::max(high_water_, used_before_ + offset_);
+            return block.memory.get() + start;
+        }
+
+        // Blocks after this one are left over from an earlier frame's overflow.
+        if (block_ + 1 == blocks_.size())
+            break;
+        used_before_ += offset_;
+        block_++;
+        offset_ = 0;
+    }
+
+    size_t block_size = std::max(block_size_, size + alignment);
+    blocks_.push_back({std::make_unique_for_overwrite<std::byte[]>(block_size), block_size});
+    capacity_ += block_size;
+    if (blocks_.size() > 1)
+    {
+        used_before_ += offset_;
+        block_ = blocks_.size() - 1;
+        offset_ = 0;
+        grew_ = true;
+    }
+    return Allocate(size, alignment);
+}
+
+void FrameArena::do_deallocate(void* p, size_t size, size_t)
+{
+    // Only the newest allocation can be given back, which covers a vector growing in place
+    // of the last thing allocated.
+    if (block_ < blocks_.size() && static_cast<std::byte*>(p) + size == blocks_[block_].memory.get() + offset_)
+        offset_ -= size;
+}
+
+void FrameArena::Reset()
+{
+    if (blocks_.size() > 1)
+    {
+        // Replace the chain with one block that fits all of it.
+        size_t size = capacity_;
+        blocks_.clear();
+        blocks_.push_back({std::make_unique_for_overwrite<std::byte[]>(size), size});
+    }
+
+#ifndef NDEBUG
+    if (grew_)
+        fprintf(stderr, "bifrost: frame arena grew to %zu KB, high-water mark %zu KB\n", capacity_ / 1024, high_water_ / 1024);
+#endif
+
+    block_ = 0;
+    offset_ = 0;
+    used_before_ = 0;
+    grew_ = false;
+}
+
+FrameArena& GetFrameArena()
+{
+    if (thread_arena.arena)
+        return *thread_arena.arena;
+
+    auto& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    if (!registry.free.empty())
+    {
+        thread_arena.arena = registry.free.back();
+        registry.free.pop_back();
+    }
+    else
+    {
+        registry.arenas.push_back(std::make_unique<FrameArena>());
+        thread_arena.arena = registry.arenas.back().get();
+    }
+    return *thread_arena.arena;
+}
+
+void ResetFrameArenas()
+{
+    auto& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    for (auto& arena : registry.arenas)
+        arena->Reset();
+}
+
+FrameArenaStats GetFrameArenaStats()
+{
+    auto& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    FrameArenaStats stats{};
+    for (auto& arena : registry.arenas)
+    {
+        stats.used += arena->Used();
+        stats.capacity += arena->Capacity();
+        stats.high_water += arena->HighWater();
+    }
+    stats.arenas = (int)registry.arenas.size();
+    return stats;
+}
+
+} // namespace bifrost
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bifrost
+{
+    // Bump allocator for data that only lives until the end of the frame. Allocation is a
+    // pointer increment; nothing is freed individually, everything goes at once on Reset().
+    // When a frame outgrows the current block another one is chained on, and the next
+    // Reset() merges them into a single block big enough for the whole frame, so a steady
+    // workload settles into one block and no heap traffic. Not thread safe; every thread
+    // has its own through GetFrameArena().
+    class FrameArena : public std::pmr::memory_resource
+    {
+    public:
+        explicit FrameArena(size_t block_size = 64 * 1024);
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        // Uninitialized storage for count objects; only use for trivially destructible types.
+        template<typename T>
+        T* Allocate(size_t count)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "arena memory is never destructed");
+            return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        // In debug builds, reports on stderr if the arena had to grow since the last reset.
+        void Reset();
+
+        size_t Used() const { return used_before_ + offset_; }
+        size_t Capacity() const { return capacity_; }
+        // Most bytes in use at once since construction.
+        size_t HighWater() const { return high_water_; }
+
+        // Gives back everything allocated during its lifetime when it's destroyed, for
+        // temporaries that don't need to last the frame. Scopes must end in reverse order.
+        class Scope
+        {
+        public:
+            explicit Scope(FrameArena& arena)
+                : arena_(arena), block_(arena.block_), offset_(arena.offset_), used_before_(arena.used_before_) {}
+            ~Scope() { arena_.block_ = block_; arena_.offset_ = offset_; arena_.used_before_ = used_before_; }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            FrameArena& arena_;
+            size_t block_;
+            size_t offset_;
+            size_t used_before_;
+        };
+
+    private:
+        struct Block
+        {
+            std::unique_ptr<std::byte[]> memory;
+            size_t size;
+        };
+
+        void* do_allocate(size_t size, size_t alignment) override { return Allocate(size, alignment); }
+        void do_deallocate(void* p, size_t size, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+        std::vector<Block> blocks_{};
+        size_t block_ = 0;          // block currently allocated from
+        size_t offset_ = 0;         // bytes used in that block
+        size_t used_before_ = 0;    // bytes used in the blocks before it
+        size_t capacity_ = 0;
+        size_t high_water_ = 0;
+        size_t block_size_;
+        bool grew_ = false;
+    };
+
+    // Containers that allocate from an arena. Growing one abandons its old storage until the
+    // next reset, so reserve up front when the size is known.
+    template<typename T>
+    using ArenaAllocator = std::pmr::polymorphic_allocator<T>;
+    template<typename T>
+    using ArenaVector = std::pmr::vector<T>;
+
+    // The calling thread's arena, created on first use.
+    FrameArena& GetFrameArena();
+
+    struct FrameArenaStats
+    {
+        size_t used;        // bytes in use across every thread's arena
+        size_t capacity;
+        size_t high_water;  // sum of the per-thread high-water marks
+        int arenas;
+    };
+
+    // Resets every thread's arena. Call once per frame at a point where no thread holds on
+    // to arena memory or is allocating from one, usually right before polling input.
+    void ResetFrameArenas();
+    FrameArenaStats GetFrameArenaStats();
+
+    // Non-owning reference to a callable, for callbacks that are only used during the call
+    // they're passed to. Unlike std::function it never allocates; the callable must outlive
+    // the reference.
+    template<typename Signature>
+    class FunctionRef;
+
+    template<typename R, typename... Args>
+    class FunctionRef<R(Args...)>
+    {
+    public:
+        template<typename F>
+            requires (!std::is_same_v<std::remove_cvref_t<F>, FunctionRef> && std::is_invocable_r_v<R, F&, Args...>)
+        FunctionRef(F&& fn)
+            : object_((void*)std::addressof(fn)),
+              call_([](void* object, Args... args) -> R { return (*static_cast<std::remove_reference_t<F>*>(object))(std::forward<Args>(args)...); })
+        {
+        }
+
+        R operator()(Args... args) const { return call_(object_, std::forward<Args>(args)...); }
+
+    private:
+        void* object_;
+        R (*call_)(void*, Args...);
+    };
+}
@@ -0,0 +1,825 @@
+#include "bifrost_audio.h"
+
+#include <miniaudio/miniaudio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace
+{
+
+constexpr uint64_t FIXED_ONE = (uint64_t)1 << 32;
+constexpr float FIXED_SCALE = 1.0f / (float)FIXED_ONE;
+
+void DataCallback(ma_device* device, void* output, const void*, ma_uint32 frame_count)
+{
+    static_cast<bifrost::AudioSystem*>(device->pUserData)->Mix(static_cast<float*>(output), frame_count);
+}
+
+// Balance rather than constant power, so a centred sound plays at its own volume.
+void GetGains(float volume, float pan, float& left, float& right)
+{
+    pan = std::clamp(pan, -1.0f, 1.0f);
+    left = volume * std::min(1.0f, 1.0f - pan);
+    right = volume * std::min(1.0f, 1.0f + pan);
+}
+
+uint64_t GetStep(float pitch)
+{
+    return (uint64_t)((double)std::clamp(pitch, 0.01f, 16.0f) * (double)FIXED_ONE);
+}
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+struct AudioSystem::MusicRequest
+{
+    std::string filename;
+    std::span<const unsigned char> encoded;
+    uint32_t generation;
+    float volume;
+    uint32_t fade_frames;
+    bool loop;
+};
+
+// One streamed track. The game thread posts requests and stops, the music thread owns the
+// decoder and the write side of the ring, and the mixer owns the read side and the fades.
+struct AudioSystem::MusicStream
+{
+    enum State : int
+    {
+        Free,
+        Playing,
+        Finished,   // the mixer is done with it; the music thread closes it
+    };
+
+    ma_pcm_rb ring;
+    std::atomic<int> state{Free};
+    // Generation and fade length in frames of the last stop, packed so they change together.
+    std::atomic<uint64_t> stop{0};
+    std::atomic<uint32_t> finished{0};
+    std::atomic<bool> end_of_stream{false};
+
+    // Game thread.
+    uint32_t requested = 0;
+
+    // Music thread; the request is guarded by music_mutex_. The track settings are written
+    // before it publishes Playing and stay put until the mixer hands it back.
+    MusicRequest request{};
+    bool has_request = false;
+    ma_decoder decoder;
+    bool decoder_open = false;
+    uint32_t generation = 0;
+    float volume = 1.0f;
+    uint32_t fade_in_frames = 0;
+    bool loop = false;
+
+    // Mixer.
+    bool active = false;
+    bool stopping = false;
+    uint32_t stop_frames = 0;
+    float gain = 0.0f;
+    float gain_step = 0.0f;     // per frame, negative while fading out
+};
+
+AudioSystem::AudioSystem(const AudioConfig& config)
+    : sample_rate_(config.sample_rate)
+{
+    size_t voice_count = (size_t)std::max(config.voice_count, 1);
+    slots_.assign(voice_count, {});
+    voices_.assign(voice_count, {});
+    finished_ = std::make_unique<std::atomic<uint32_t>[]>(voice_count);
+
+    for (auto& stream : music_)
+    {
+        stream = std::make_unique<MusicStream>();
+        if (ma_pcm_rb_init(ma_format_f32, 2, config.music_buffer_frames, nullptr, nullptr, &stream->ring) != MA_SUCCESS)
+            fprintf(stderr, "bifrost: could not allocate music buffer\n");
+    }
+
+    if (config.output == AudioOutput::Offline)
+    {
+        open_ = true;
+        return;
+    }
+
+    context_ = new ma_context;
+    ma_backend null_backend = ma_backend_null;
+    bool use_null = config.output == AudioOutput::Null;
+    if (ma_context_init(use_null ? &null_backend : nullptr, use_null ? 1 : 0, nullptr, context_) != MA_SUCCESS)
+    {
+        fprintf(stderr, "bifrost: could not initialize audio context\n");
+        delete context_;
+        context_ = nullptr;
+        return;
+    }
+
+    ma_device_config device_config = ma_device_config_init(ma_device_type_playback);
+    device_config.playback.format = ma_format_f32;
+    device_config.playback.channels = 2;
+    device_config.sampleRate = sample_rate_;
+    device_config.dataCallback = DataCallback;
+    device_config.pUserData = this;
+    device_config.noPreSilencedOutputBuffer = MA_TRUE; // Mix() clears it
+
+    device_ = new ma_device;
+    if (ma_device_init(context_, &device_config, device_) != MA_SUCCESS)
+    {
+        fprintf(stderr, "bifrost: could not open audio device\n");
+        delete device_;
+        device_ = nullptr;
+        return;
+    }
+    if (ma_device_start(device_) != MA_SUCCESS)
+    {
+        fprintf(stderr, "bifrost: could not start audio device\n");
+        return;
+    }
+    open_ = true;
+}
+
+AudioSystem::~AudioSystem()
+{
+    if (device_)
+    {
+        ma_device_uninit(device_);
+        delete device_;
+    }
+    if (music_thread_.joinable())
+    {
+        {
+            std::lock_guard lock(music_mutex_);
+            music_running_ = false;
+        }
+        music_wake_.notify_one();
+        music_thread_.join();
+    }
+    for (auto& stream : music_)
+    {
+        if (stream->decoder_open)
+            ma_decoder_uninit(&stream->decoder);
+        ma_pcm_rb_uninit(&stream->ring);
+    }
+    if (context_)
+    {
+        ma_context_uninit(context_);
+        delete context_;
+    }
+}
+
+Sound AudioSystem::LoadSound(const char* filename)
+{
+    ma_decoder_config decoder_config = ma_decoder_config_init(ma_format_f32, 2, sample_rate_);
+    ma_uint64 frame_count = 0;
+    void* frames = nullptr;
+    if (ma_decode_file(filename, &decoder_config, &frame_count, &frames) != MA_SUCCESS)
+    {
+        fprintf(stderr, "bifrost: could not decode sound %s\n", filename);
+        return {};
+    }
+    return AddClip(static_cast<float*>(frames), frame_count);
+}
+
+Sound AudioSystem::LoadSound(std::span<const unsigned char> encoded)
+{
+    ma_decoder_config decoder_config = ma_decoder_config_init(ma_format_f32, 2, sample_rate_);
+    ma_uint64 frame_count = 0;
+    void* frames = nullptr;
+    if (ma_decode_memory(encoded.data(), encoded.size(), &decoder_config, &frame_count, &frames) != MA_SUCCESS)
+    {
+        fprintf(stderr, "bifrost: could not decode sound from memory\n");
+        return {};
+    }
+    return AddClip(static_cast<float*>(frames), frame_count);
+}
+
+Sound AudioSystem::AddClip(float* frames, uint64_t frame_count)
+{
+    auto clip = std::make_unique<Clip>();
+    clip->samples.assign(frames, frames + frame_count * 2);
+    clip->frame_count = frame_count;
+    ma_free(frames, nullptr);
+
+    clips_.push_back(std::move(clip));
+    return {(uint32_t)clips_.size()};
+}
+
+Voice AudioSystem::PlaySound(Sound sound, const PlayParams& params)
+{
+    float left, right;
+    GetGains(params.volume, params.pan, left, right);
+    Voice voice = StartVoice(sound, params, left, right);
+    if (voice.generation != 0)
+        slots_[voice.index].positional = false;
+    return voice;
+}
+
+Voice AudioSystem::PlaySoundAt(Sound sound, glm::vec2 position, const PlayParams& params)
+{
+    float left, right;
+    GetPositionalGains(position, params.volume, left, right);
+    Voice voice = StartVoice(sound, params, left, right);
+    if (voice.generation != 0)
+    {
+        VoiceSlot& slot = slots_[voice.index];
+        slot.positional = true;
+        slot.position = position;
+    }
+    return voice;
+}
+
+Voice AudioSystem::StartVoice(Sound sound, const PlayParams& params, float gain_left, float gain_right)
+{
+    if (!open_ || sound.id == 0 || sound.id > clips_.size() || clips_[sound.id - 1]->frame_count == 0)
+        return {};
+
+    int best = -1;
+    bool stealing = false;
+    for (uint32_t i = 0; i < slots_.size(); i++)
+    {
+        if (IsSlotFree(i))
+        {
+            best = (int)i;
+            break;
+        }
+    }
+
+    if (best < 0)
+    {
+        stealing = true;
+        for (uint32_t i = 0; i < slots_.size(); i++)
+        {
+            const VoiceSlot& slot = slots_[i];
+            if (slot.priority > params.priority)
+                continue;
+            if (best < 0 || slot.priority < slots_[best].priority
+                || (slot.priority == slots_[best].priority && slot.started < slots_[best].started))
+                best = (int)i;
+        }
+    }
+
+    if (best < 0)
+    {
+        plays_dropped_++;
+        return {};
+    }
+
+    VoiceSlot& slot = slots_[best];
+    uint32_t generation = slot.generation + 1 == 0 ? 1 : slot.generation + 1;
+
+    Command command{};
+    command.type = CommandType::Play;
+    command.loop = params.loop;
+    command.voice = (uint32_t)best;
+    command.generation = generation;
+    command.clip = clips_[sound.id - 1].get();
+    command.gain_left = gain_left;
+    command.gain_right = gain_right;
+    command.step = GetStep(params.pitch);
+    if (!Push(command))
+    {
+        plays_dropped_++;
+        return {};
+    }
+
+    if (stealing)
+        voices_stolen_++;
+    slot = {generation, params.priority, play_count_++, true, false, {}, params.volume, gain_left, gain_right};
+    return {(uint32_t)best, generation};
+}
+
+void AudioSystem::StopVoice(Voice voice)
+{
+    if (!IsPlaying(voice))
+        return;
+    Command command{};
+    command.type = CommandType::Stop;
+    command.voice = voice.index;
+    command.generation = voice.generation;
+    if (Push(command))
+        slots_[voice.index].busy = false;
+}
+
+void AudioSystem::SetVoiceVolume(Voice voice, float volume, float pan)
+{
+    if (!IsPlaying(voice))
+        return;
+    VoiceSlot& slot = slots_[voice.index];
+    slot.volume = volume;
+    if (slot.positional)
+        return;
+
+    Command command{};
+    command.type = CommandType::SetGain;
+    command.voice = voice.index;
+    command.generation = voice.generation;
+    GetGains(volume, pan, command.gain_left, command.gain_right);
+    if (Push(command))
+    {
+        slot.gain_left = command.gain_left;
+        slot.gain_right = command.gain_right;
+    }
+}
+
+void AudioSystem::SetVoicePitch(Voice voice, float pitch)
+{
+    if (!IsPlaying(voice))
+        return;
+    Command command{};
+    command.type = CommandType::SetPitch;
+    command.voice = voice.index;
+    command.generation = voice.generation;
+    command.step = GetStep(pitch);
+    Push(command);
+}
+
+void AudioSystem::SetVoicePosition(Voice voice, glm::vec2 position)
+{
+    if (IsPlaying(voice))
+        slots_[voice.index].position = position;
+}
+
+bool AudioSystem::IsPlaying(Voice voice) const
+{
+    if (voice.generation == 0 || voice.index >= slots_.size())
+        return false;
+    const VoiceSlot& slot = slots_[voice.index];
+    return slot.generation == voice.generation && !IsSlotFree(voice.index);
+}
+
+void AudioSystem::StopAll()
+{
+    Command command{};
+    command.type = CommandType::StopAll;
+    if (!Push(command))
+        return;
+    for (auto& slot : slots_)
+        slot.busy = false;
+}
+
+void AudioSystem::UpdateListener(const Camera2d& camera)
+{
+    // A hand-built camera has no view bounds; derive them from its projection.
+    Aabb view = camera.view.max.x < std::numeric_limits<float>::max() ? camera.view : GetViewBounds(camera);
+    listener_center_ = (view.min + view.max) * 0.5f;
+    listener_half_size_ = glm::max((view.max - view.min) * 0.5f, glm::vec2(1e-6f));
+
+    // Only changes worth hearing go to the mixer, so a still scene sends nothing.
+    constexpr float EPSILON = 1.0f / 1024.0f;
+    culled_voices_ = 0;
+    for (uint32_t i = 0; i < slots_.size(); i++)
+    {
+        VoiceSlot& slot = slots_[i];
+        if (!slot.positional || IsSlotFree(i))
+            continue;
+
+        float left, right;
+        GetPositionalGains(slot.position, slot.volume, left, right);
+        if (left == 0.0f && right == 0.0f)
+            culled_voices_++;
+        if (std::abs(left - slot.gain_left) < EPSILON && std::abs(right - slot.gain_right) < EPSILON
+            && (left == 0.0f) == (slot.gain_left == 0.0f) && (right == 0.0f) == (slot.gain_right == 0.0f))
+            continue;
+
+        Command command{};
+        command.type = CommandType::SetGain;
+        command.voice = i;
+        command.generation = slot.generation;
+        command.gain_left = left;
+        command.gain_right = right;
+        if (Push(command))
+        {
+            slot.gain_left = left;
+            slot.gain_right = right;
+        }
+    }
+}
+
+void AudioSystem::GetPositionalGains(glm::vec2 position, float volume, float& left, float& right) const
+{
+    glm::vec2 offset = (position - listener_center_) / listener_half_size_;
+    float distance = glm::length(offset);
+    const ListenerParams& params = listener_params_;
+    if (distance >= params.audible_radius)
+    {
+        left = right = 0.0f;
+        return;
+    }
+
+    float falloff = params.audible_radius - params.full_volume_radius;
+    float attenuation = distance <= params.full_volume_radius || falloff <= 0.0f
+        ? 1.0f : 1.0f - (distance - params.full_volume_radius) / falloff;
+    GetGains(volume * attenuation, offset.x, left, right);
+}
+
+void AudioSystem::PlayMusic(const char* filename, const MusicParams& params)
+{
+    QueueMusic({filename, {}, 0, params.volume, (uint32_t)(params.fade_seconds * sample_rate_), params.loop});
+}
+
+void AudioSystem::PlayMusic(std::span<const unsigned char> encoded, const MusicParams& params)
+{
+    QueueMusic({{}, encoded, 0, params.volume, (uint32_t)(params.fade_seconds * sample_rate_), params.loop});
+}
+
+void AudioSystem::StopMusic(float fade_seconds)
+{
+    if (music_current_ < 0)
+        return;
+    StopStream(*music_[music_current_], fade_seconds);
+    music_current_ = -1;
+}
+
+bool AudioSystem::IsMusicPlaying() const
+{
+    if (music_current_ < 0)
+        return false;
+    const MusicStream& stream = *music_[music_current_];
+    return stream.finished.load(std::memory_order_acquire) != stream.requested;
+}
+
+AudioStats AudioSystem::GetStats() const
+{
+    return {active_voices_.load(std::memory_order_relaxed), voices_stolen_, plays_dropped_, mix_ms_.load(std::memory_order_relaxed),
+            music_underruns_.load(std::memory_order_relaxed), culled_voices_};
+}
+
+void AudioSystem::QueueMusic(MusicRequest&& request)
+{
+    if (!open_)
+        return;
+    if (!music_thread_.joinable())
+    {
+        music_running_ = true;
+        music_thread_ = std::thread(&AudioSystem::RunMusicThread, this);
+    }
+
+    // The new track goes on the other stream, cutting whatever is still fading out there.
+    size_t next = music_current_ == 0 ? 1 : 0;
+    if (music_current_ >= 0)
+        StopStream(*music_[music_current_], (float)request.fade_frames / sample_rate_);
+    StopStream(*music_[next], 0.0f);
+
+    music_generation_ = music_generation_ + 1 == 0 ? 1 : music_generation_ + 1;
+    request.generation = music_generation_;
+    MusicStream& stream = *music_[next];
+    stream.requested = request.generation;
+    {
+        std::lock_guard lock(music_mutex_);
+        stream.request = std::move(request);
+        stream.has_request = true;
+    }
+    music_wake_.notify_one();
+    music_current_ = (int)next;
+}
+
+void AudioSystem::StopStream(MusicStream& stream, float fade_seconds)
+{
+    if (stream.requested == 0)
+        return;
+    uint32_t fade_frames = (uint32_t)(std::max(fade_seconds, 0.0f) * sample_rate_);
+    stream.stop.store((uint64_t)stream.requested << 32 | fade_frames, std::memory_order_release);
+}
+
+void AudioSystem::RunMusicThread()
+{
+    // Decodes until the ring is full, rewinding looping tracks at the end so the seam is
+    // just the next frame in the ring.
+    auto fill = [](MusicStream& stream) {
+        bool rewound = false;
+        while (!stream.end_of_stream.load(std::memory_order_relaxed))
+        {
+            ma_uint32 frame_count = ma_pcm_rb_available_write(&stream.ring);
+            if (frame_count == 0)
+                break;
+
+            void* buffer = nullptr;
+            ma_pcm_rb_acquire_write(&stream.ring, &frame_count, &buffer);
+            ma_uint64 read = 0;
+            ma_decoder_read_pcm_frames(&stream.decoder, buffer, frame_count, &read);
+            ma_pcm_rb_commit_write(&stream.ring, (ma_uint32)read);
+
+            if (read > 0)
+                rewound = false;
+            if (read < frame_count)
+            {
+                if (stream.loop && !rewound)
+                {
+                    ma_decoder_seek_to_pcm_frame(&stream.decoder, 0);
+                    rewound = true;
+                }
+                else
+                {
+                    stream.end_of_stream.store(true, std::memory_order_release);
+                }
+            }
+        }
+    };
+
+    auto start = [this, &fill](MusicStream& stream, const MusicRequest& request) {
+        // Stopped again before it got here.
+        if ((uint32_t)(stream.stop.load(std::memory_order_acquire) >> 32) == request.generation)
+        {
+            stream.finished.store(request.generation, std::memory_order_release);
+            return;
+        }
+
+        ma_decoder_config config = ma_decoder_config_init(ma_format_f32, 2, sample_rate_);
+        ma_result result = request.filename.empty()
+            ? ma_decoder_init_memory(request.encoded.data(), request.encoded.size(), &config, &stream.decoder)
+            : ma_decoder_init_file(request.filename.c_str(), &config, &stream.decoder);
+        if (result != MA_SUCCESS)
+        {
+            fprintf(stderr, "bifrost: could not open music %s\n", request.filename.empty() ? "from memory" : request.filename.c_str());
+            stream.finished.store(request.generation, std::memory_order_release);
+            return;
+        }
+
+        stream.decoder_open = true;
+        stream.generation = request.generation;
+        stream.volume = request.volume;
+        stream.fade_in_frames = request.fade_frames;
+        stream.loop = request.loop;
+        fill(stream);
+        stream.state.store(MusicStream::Playing, std::memory_order_release);
+    };
+
+    std::unique_lock lock(music_mutex_);
+    while (music_running_)
+    {
+        for (auto& stream_ptr : music_)
+        {
+            MusicStream& stream = *stream_ptr;
+            int state = stream.state.load(std::memory_order_acquire);
+            if (state == MusicStream::Finished)
+            {
+                ma_decoder_uninit(&stream.decoder);
+                stream.decoder_open = false;
+                ma_pcm_rb_reset(&stream.ring);
+                stream.end_of_stream.store(false, std::memory_order_relaxed);
+                stream.state.store(MusicStream::Free, std::memory_order_release);
+                state = MusicStream::Free;
+            }
+
+            if (state == MusicStream::Free && stream.has_request)
+            {
+                MusicRequest request = std::move(stream.request);
+                stream.has_request = false;
+                lock.unlock();
+                start(stream, request);
+                lock.lock();
+            }
+            else if (state == MusicStream::Playing)
+            {
+                lock.unlock();
+                fill(stream);
+                lock.lock();
+            }
+        }
+        music_wake_.wait_for(lock, std::chrono::milliseconds(10));
+    }
+}
+
+void AudioSystem::MixMusic(MusicStream& stream, float* out, uint32_t frame_count, float master)
+{
+    if (!stream.active)
+    {
+        if (stream.state.load(std::memory_order_acquire) != MusicStream::Playing)
+            return;
+        stream.active = true;
+        stream.stopping = false;
+        stream.gain = stream.fade_in_frames > 0 ? 0.0f : 1.0f;
+        stream.gain_step = stream.fade_in_frames > 0 ? 1.0f / stream.fade_in_frames : 0.0f;
+    }
+
+    // A shorter fade can cut into one already running, e.g. a quick crossfade after a slow
+    // fade out.
+    uint64_t stop = stream.stop.load(std::memory_order_acquire);
+    if ((uint32_t)(stop >> 32) == stream.generation)
+    {
+        uint32_t stop_frames = (uint32_t)stop;
+        if (!stream.stopping || stop_frames < stream.stop_frames)
+        {
+            stream.stopping = true;
+            stream.stop_frames = stop_frames;
+            stream.gain_step = stop_frames > 0 ? -stream.gain / stop_frames : 0.0f;
+        }
+    }
+
+    bool finished = stream.stopping && (stream.stop_frames == 0 || stream.gain <= 0.0f);
+    float volume = stream.volume * master;
+    uint32_t mixed = 0;
+    while (!finished && mixed < frame_count)
+    {
+        bool end = stream.end_of_stream.load(std::memory_order_acquire);
+        ma_uint32 available = frame_count - mixed;
+        void* buffer = nullptr;
+        ma_pcm_rb_acquire_read(&stream.ring, &available, &buffer);
+        if (available == 0)
+        {
+            if (end)
+                finished = true;
+            else
+                music_underruns_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+
+        const float* in = static_cast<const float*>(buffer);
+        float* dst = out + (size_t)mixed * 2;
+        for (ma_uint32 i = 0; i < available; i++)
+        {
+            float gain = stream.gain * volume;
+            dst[i * 2] += in[i * 2] * gain;
+            dst[i * 2 + 1] += in[i * 2 + 1] * gain;
+            stream.gain = std::clamp(stream.gain + stream.gain_step, 0.0f, 1.0f);
+        }
+        ma_pcm_rb_commit_read(&stream.ring, available);
+        mixed += available;
+
+        if (stream.stopping && stream.gain <= 0.0f)
+            finished = true;
+    }
+
+    if (finished)
+    {
+        stream.active = false;
+        stream.finished.store(stream.generation, std::memory_order_release);
+        stream.state.store(MusicStream::Finished, std::memory_order_release);
+    }
+}
+
+bool AudioSystem::IsSlotFree(uint32_t index) const
+{
+    const VoiceSlot& slot = slots_[index];
+    return !slot.busy || finished_[index].load(std::memory_order_acquire) == slot.generation;
+}
+
+bool AudioSystem::Push(const Command& command)
+{
+    size_t head = command_head_.load(std::memory_order_relaxed);
+    size_t next = (head + 1) % COMMAND_CAPACITY;
+    if (next == command_tail_.load(std::memory_order_acquire))
+        return false;
+    commands_[head] = command;
+    command_head_.store(next, std::memory_order_release);
+    return true;
+}
+
+void AudioSystem::Apply(const Command& command)
+{
+    if (command.type == CommandType::StopAll)
+    {
+        for (auto& voice : voices_)
+            voice.clip = nullptr;
+        return;
+    }
+
+    MixVoice& voice = voices_[command.voice];
+    if (command.type == CommandType::Play)
+    {
+        voice = {command.clip, 0, command.step, command.gain_left, command.gain_right, command.generation, command.loop};
+        return;
+    }
+
+    // Commands for a sound that has since finished or been replaced.
+    if (voice.generation != command.generation || !voice.clip)
+        return;
+
+    switch (command.type)
+    {
+        case CommandType::Stop:     voice.clip = nullptr; break;
+        case CommandType::SetGain:  voice.gain_left = command.gain_left; voice.gain_right = command.gain_right; break;
+        case CommandType::SetPitch: voice.step = command.step; break;
+        default: break;
+    }
+}
+
+void AudioSystem::Mix(float* out, uint32_t frame_count)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    size_t tail = command_tail_.load(std::memory_order_relaxed);
+    size_t head = command_head_.load(std::memory_order_acquire);
+    for (; tail != head; tail = (tail + 1) % COMMAND_CAPACITY)
+        Apply(commands_[tail]);
+    command_tail_.store(tail, std::memory_order_release);
+
+    memset(out, 0, sizeof(float) * 2 * frame_count);
+    float master = master_volume_.load(std::memory_order_relaxed);
+    int active = 0;
+
+    for (size_t v = 0; v < voices_.size(); v++)
+    {
+        MixVoice& voice = voices_[v];
+        if (!voice.clip)
+            continue;
+        active++;
+
+        const float* samples = voice.clip->samples.data();
+        const uint64_t length = voice.clip->frame_count;
+        const float left = voice.gain_left * master;
+        const float right = voice.gain_right * master;
+        bool finished = false;
+
+        if (left == 0.0f && right == 0.0f)
+        {
+            // Culled or muted: keep time without touching the samples, so it picks up in the
+            // right place when it becomes audible again.
+            const uint64_t end = length << 32;
+            voice.position += voice.step * frame_count;
+            if (voice.position >= end)
+            {
+                if (voice.loop)
+                    voice.position %= end;
+                else
+                    finished = true;
+            }
+        }
+        else if (voice.step == FIXED_ONE && (voice.position & (FIXED_ONE - 1)) == 0 && (voice.position >> 32) < length)
+        {
+            // Unpitched: straight runs of samples up to the end of the clip.
+            uint64_t position = voice.position >> 32;
+            uint32_t i = 0;
+            while (i < frame_count)
+            {
+                uint32_t run = (uint32_t)std::min<uint64_t>(frame_count - i, length - position);
+                const float* in = samples + position * 2;
+                float* dst = out + (size_t)i * 2;
+                for (uint32_t k = 0; k < run; k++)
+                {
+                    dst[k * 2] += in[k * 2] * left;
+                    dst[k * 2 + 1] += in[k * 2 + 1] * right;
+                }
+                i += run;
+                position += run;
+                if (position >= length)
+                {
+                    if (!voice.loop)
+                    {
+                        finished = true;
+                        break;
+                    }
+                    position = 0;
+                }
+            }
+            voice.position = position << 32;
+        }
+        else
+        {
+            // Pitched: linear interpolation between neighbouring frames.
+            const uint64_t end = length << 32;
+            uint64_t position = voice.position;
+            for (uint32_t i = 0; i < frame_count; i++)
+            {
+                if (position >= end)
+                {
+                    if (!voice.loop)
+                    {
+                        finished = true;
+                        break;
+                    }
+                    position %= end;
+                }
+
+                uint64_t index = position >> 32;
+                uint64_t next = index + 1 < length ? index + 1 : (voice.loop ? 0 : index);
+                float t = (float)(position & (FIXED_ONE - 1)) * FIXED_SCALE;
+                out[i * 2] += (samples[index * 2] + (samples[next * 2] - samples[index * 2]) * t) * left;
+                out[i * 2 + 1] += (samples[index * 2 + 1] + (samples[next * 2 + 1] - samples[index * 2 + 1]) * t) * right;
+                position += voice.step;
+            }
+
+            // Leave position inside the clip, so a pitch change before the next callback
+            // can't hand the unpitched path a start past the end.
+            if (!finished && position >= end)
+            {
+                if (voice.loop)
+                    position %= end;
+                else
+                    finished = true;
+            }
+            voice.position = position;
+        }
+
+        if (finished)
+        {
+            voice.clip = nullptr;
+            finished_[v].store(voice.generation, std::memory_order_release);
+        }
+    }
+
+    for (auto& stream : music_)
+        MixMusic(*stream, out, frame_count, master);
+
+    active_voices_.store(active, std::memory_order_relaxed);
+    mix_ms_.store(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+}
+
+} // namespace bifrost
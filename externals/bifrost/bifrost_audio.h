@@ -0,0 +1,255 @@
+#pragma once
+
+#include "bifrost.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+struct ma_context;
+struct ma_device;
+
+namespace bifrost
+{
+    enum class AudioOutput
+    {
+        Device,     // the default playback device
+        Null,       // miniaudio's null backend: mixes on its own thread at real-time pace
+                    // without sound hardware, for headless runs and benchmarks
+        Offline,    // no device; the owner pulls audio with Mix()
+    };
+
+    struct AudioConfig
+    {
+        int voice_count = 64;
+        uint32_t sample_rate = 48000;
+        AudioOutput output = AudioOutput::Device;
+        // Decoded frames buffered ahead for each music stream, which is all the memory a
+        // streamed track takes however long it is; 32768 frames is 256KB, ~0.7s at 48kHz.
+        uint32_t music_buffer_frames = 32768;
+    };
+
+    // A clip decoded up front; zero is no sound.
+    struct Sound
+    {
+        uint32_t id;
+    };
+
+    // A playing instance of a sound. Goes stale once the voice finishes or is stolen.
+    struct Voice
+    {
+        uint32_t index;
+        uint32_t generation;
+    };
+
+    struct PlayParams
+    {
+        float volume = 1.0f;
+        float pan = 0.0f;       // -1 left to 1 right
+        float pitch = 1.0f;     // playback rate
+        int priority = 0;       // higher priorities steal voices from lower ones
+        bool loop = false;
+    };
+
+    // How positional voices fall off, in half-screens from the camera center: a sound at
+    // the edge of the view is 1 away horizontally or vertically.
+    struct ListenerParams
+    {
+        float full_volume_radius = 0.5f;
+        float audible_radius = 1.5f;     // silent and culled beyond this
+    };
+
+    struct MusicParams
+    {
+        float volume = 1.0f;
+        float fade_seconds = 0.0f;  // fade in, and crossfade out of the track playing before
+        bool loop = true;
+    };
+
+    struct AudioStats
+    {
+        int active_voices;
+        uint64_t voices_stolen;
+        uint64_t plays_dropped;     // no voice of lower or equal priority, or a full command queue
+        double mix_ms;              // time the audio thread spent in the last Mix()
+        uint64_t music_underruns;   // mixes a music stream ran dry before the decoder caught up
+        int culled_voices;          // positional voices out of earshot at the last UpdateListener()
+    };
+
+    // Stereo float mixer on a miniaudio device. Sounds are decoded once at load time into
+    // PCM at the device rate that every voice playing them shares. Voices come from a pool
+    // allocated up front; PlaySound() takes a free one, or steals the oldest voice of the
+    // lowest priority at or below the new sound's, and passes the start to the audio thread
+    // through a fixed-size queue, so playing a sound never allocates, locks or decodes.
+    //
+    // Positional voices take a world position instead of a pan. UpdateListener() derives pan
+    // and attenuation for all of them from the camera once a frame; voices out of earshot
+    // are culled, and the mixer only advances their play position.
+    //
+    // Music is streamed instead: a background thread decodes tracks in chunks into a ring
+    // buffer per stream that the mixer reads without locking. Two streams let one track
+    // crossfade into the next.
+    //
+    // Load, play, stop and change voices from one thread, usually the game thread.
+    class AudioSystem
+    {
+    public:
+        explicit AudioSystem(const AudioConfig& config = {});
+        ~AudioSystem();
+
+        AudioSystem(const AudioSystem&) = delete;
+        AudioSystem& operator=(const AudioSystem&) = delete;
+
+        // False if the device couldn't be started; every call is then a harmless no-op.
+        bool IsOpen() const { return open_; }
+
+        // Decodes a whole file or encoded buffer (wav, flac, mp3). Logs and returns the zero
+        // sound on failure.
+        Sound LoadSound(const char* filename);
+        Sound LoadSound(std::span<const unsigned char> encoded);
+
+        Voice PlaySound(Sound sound, const PlayParams& params = {});
+        // params.pan is ignored; pan follows the position.
+        Voice PlaySoundAt(Sound sound, glm::vec2 position, const PlayParams& params = {});
+        void StopVoice(Voice voice);
+        void SetVoiceVolume(Voice voice, float volume, float pan = 0.0f);
+        void SetVoicePitch(Voice voice, float pitch);
+        // Takes effect at the next UpdateListener().
+        void SetVoicePosition(Voice voice, glm::vec2 position);
+        bool IsPlaying(Voice voice) const;
+        void StopAll();
+
+        // Call once a frame after moving emitters, with the camera the world is drawn with.
+        void UpdateListener(const Camera2d& camera);
+        void SetListenerParams(const ListenerParams& params) { listener_params_ = params; }
+
+        // Streams a track, crossfading from the one playing over params.fade_seconds. Memory
+        // must stay valid until the track stops, e.g. a mapped AssetArchive entry.
+        void PlayMusic(const char* filename, const MusicParams& params = {});
+        void PlayMusic(std::span<const unsigned char> encoded, const MusicParams& params = {});
+        void StopMusic(float fade_seconds = 0.0f);
+        bool IsMusicPlaying() const;
+
+        void SetMasterVolume(float volume) { master_volume_.store(volume, std::memory_order_relaxed); }
+        AudioStats GetStats() const;
+        uint32_t SampleRate() const { return sample_rate_; }
+
+        // Mixes frame_count interleaved stereo frames into out. The device calls this on its
+        // own thread; call it directly only with AudioOutput::Offline.
+        void Mix(float* out, uint32_t frame_count);
+
+    private:
+        struct Clip
+        {
+            std::vector<float> samples; // interleaved stereo
+            uint64_t frame_count;
+        };
+
+        enum class CommandType : uint8_t
+        {
+            Play,
+            Stop,
+            SetGain,
+            SetPitch,
+            StopAll,
+        };
+
+        struct Command
+        {
+            CommandType type;
+            bool loop;
+            uint32_t voice;
+            uint32_t generation;
+            const Clip* clip;
+            float gain_left;
+            float gain_right;
+            uint64_t step;          // 32.32 fixed-point frames per output frame
+        };
+
+        // Owned by the audio thread.
+        struct MixVoice
+        {
+            const Clip* clip;
+            uint64_t position;      // 32.32 fixed-point frame
+            uint64_t step;
+            float gain_left;
+            float gain_right;
+            uint32_t generation;
+            bool loop;
+        };
+
+        // Owned by the thread that plays sounds.
+        struct VoiceSlot
+        {
+            uint32_t generation;
+            int priority;
+            uint64_t started;
+            bool busy;
+            bool positional;
+            glm::vec2 position;
+            float volume;
+            float gain_left;        // last sent to the mixer
+            float gain_right;
+        };
+
+        struct MusicStream;
+        struct MusicRequest;
+
+        static constexpr size_t COMMAND_CAPACITY = 1024;
+        static constexpr size_t MUSIC_STREAMS = 2;
+
+        Sound AddClip(float* frames, uint64_t frame_count);
+        bool Push(const Command& command);
+        void Apply(const Command& command);
+        bool IsSlotFree(uint32_t index) const;
+        Voice StartVoice(Sound sound, const PlayParams& params, float gain_left, float gain_right);
+        void GetPositionalGains(glm::vec2 position, float volume, float& left, float& right) const;
+        void QueueMusic(MusicRequest&& request);
+        void StopStream(MusicStream& stream, float fade_seconds);
+        void MixMusic(MusicStream& stream, float* out, uint32_t frame_count, float master);
+        void RunMusicThread();
+
+        ma_context* context_ = nullptr;
+        ma_device* device_ = nullptr;
+        bool open_ = false;
+        uint32_t sample_rate_;
+
+        std::vector<std::unique_ptr<Clip>> clips_{};
+        std::vector<VoiceSlot> slots_{};
+        std::vector<MixVoice> voices_{};
+        // Generation of the last sound each voice finished on its own, written by the mixer.
+        std::unique_ptr<std::atomic<uint32_t>[]> finished_{};
+        uint64_t play_count_ = 0;
+
+        // Single producer, single consumer.
+        std::array<Command, COMMAND_CAPACITY> commands_{};
+        std::atomic<size_t> command_head_{0};
+        std::atomic<size_t> command_tail_{0};
+
+        std::atomic<float> master_volume_{1.0f};
+        std::atomic<int> active_voices_{0};
+        std::atomic<double> mix_ms_{0.0};
+        uint64_t voices_stolen_ = 0;
+        uint64_t plays_dropped_ = 0;
+
+        ListenerParams listener_params_{};
+        glm::vec2 listener_center_{0.0f};
+        glm::vec2 listener_half_size_{1.0f};
+        int culled_voices_ = 0;
+
+        std::array<std::unique_ptr<MusicStream>, MUSIC_STREAMS> music_{};
+        int music_current_ = -1;
+        uint32_t music_generation_ = 0;
+        std::atomic<uint64_t> music_underruns_{0};
+        std::mutex music_mutex_{};
+        std::condition_variable music_wake_{};
+        bool music_running_ = false;
+        std::thread music_thread_{};
+    };
+}
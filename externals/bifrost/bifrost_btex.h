@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+namespace bifrost
+{
+    // Cooked texture container written by tools/cooktex.cpp and read by LoadTexture. Data is
+    // already in the layout GL uploads, bottom row first like the stb loaders produce, so
+    // loading is a straight copy into texture storage:
+    //   BtexHeader
+    //   mip_count BtexMip, largest level first
+    //   level data, each level starting on a 16 byte boundary
+    static constexpr uint32_t BTEX_MAGIC = 0x58455442; // "BTEX"
+    static constexpr uint32_t BTEX_VERSION = 1;
+
+    enum class BtexFormat : uint32_t
+    {
+        Rgba8 = 1,
+        Bc7 = 2,        // GL_COMPRESSED_RGBA_BPTC_UNORM, 16 bytes per 4x4 block
+        Etc2Rgba8 = 3,  // GL_COMPRESSED_RGBA8_ETC2_EAC, 16 bytes per 4x4 block
+    };
+
+    enum BtexFlags : uint32_t
+    {
+        // Color is multiplied by alpha; LoadTexture sets Texture::premultiplied.
+        BTEX_PREMULTIPLIED = 1,
+    };
+
+    struct BtexHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t mip_count;
+        uint32_t flags;
+        uint32_t reserved;
+    };
+
+    struct BtexMip
+    {
+        uint64_t offset;    // from the start of the file
+        uint64_t size;
+    };
+
+    inline uint64_t GetBtexLevelSize(BtexFormat format, uint32_t width, uint32_t height)
+    {
+        if (format == BtexFormat::Rgba8)
+            return (uint64_t)width * height * 4;
+        return (uint64_t)((width + 3) / 4) * ((height + 3) / 4) * 16;
+    }
+}
@@ -0,0 +1,149 @@
+#include "bifrost_camera.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+constexpr float MIN_ZOOM = 1e-4f;
+
+// Smooth, zero-centered wobble in [-1, 1] per axis. The frequencies don't share a period,
+// so it never visibly repeats, and unlike random jitter it doesn't strobe at high rates.
+glm::vec2 ShakeNoise(float t)
+{
+    return glm::vec2(0.6f * std::sin(t * 37.0f) + 0.4f * std::sin(t * 23.3f + 1.7f),
+                     0.6f * std::sin(t * 31.0f + 0.9f) + 0.4f * std::sin(t * 19.7f + 2.9f));
+}
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+Camera::Camera(glm::vec2 viewport, glm::vec2 position, float zoom, float rotation)
+    : viewport_(viewport), position_(position), zoom_(std::max(zoom, MIN_ZOOM)), rotation_(rotation)
+{
+}
+
+void Camera::SetViewport(glm::vec2 viewport)
+{
+    viewport_ = viewport;
+    dirty_ = true;
+}
+
+void Camera::SetPosition(glm::vec2 position)
+{
+    position_ = position;
+    following_ = false;
+    dirty_ = true;
+}
+
+void Camera::Move(glm::vec2 offset)
+{
+    position_ += offset;
+    dirty_ = true;
+}
+
+void Camera::SetZoom(float zoom)
+{
+    zoom_ = std::max(zoom, MIN_ZOOM);
+    dirty_ = true;
+}
+
+void Camera::SetRotation(float rotation)
+{
+    rotation_ = rotation;
+    dirty_ = true;
+}
+
+void Camera::Follow(glm::vec2 target, float rate, glm::vec2 dead_zone)
+{
+    following_ = true;
+    follow_target_ = target;
+    follow_rate_ = rate;
+    dead_zone_ = glm::abs(dead_zone);
+}
+
+void Camera::StopFollowing()
+{
+    following_ = false;
+}
+
+void Camera::Shake(float magnitude, float duration)
+{
+    float fade = shake_left_ > 0.0f ? shake_left_ / shake_duration_ : 0.0f;
+    if (magnitude < shake_magnitude_ * fade * fade)
+        return;
+    shake_magnitude_ = magnitude;
+    shake_duration_ = std::max(duration, 1e-3f);
+    shake_left_ = shake_duration_;
+}
+
+void Camera::Update(float dt)
+{
+    if (following_)
+    {
+        glm::vec2 distance = follow_target_ - position_;
+        glm::vec2 outside = distance - glm::clamp(distance, -dead_zone_, dead_zone_);
+        if (outside != glm::vec2(0.0f))
+        {
+            position_ += outside * (1.0f - std::exp(-follow_rate_ * dt));
+            dirty_ = true;
+        }
+    }
+
+    if (shake_left_ > 0.0f)
+    {
+        shake_left_ = std::max(shake_left_ - dt, 0.0f);
+        shake_time_ += dt;
+        float fade = shake_left_ / shake_duration_;
+        shake_offset_ = shake_magnitude_ * fade * fade * ShakeNoise(shake_time_);
+        dirty_ = true;
+    }
+}
+
+const Camera2d& Camera::Get() const
+{
+    if (dirty_)
+        Rebuild();
+    return camera_;
+}
+
+glm::vec2 Camera::ScreenToWorld(glm::vec2 screen) const
+{
+    if (dirty_)
+        Rebuild();
+    glm::vec2 ndc = screen / viewport_ * 2.0f - 1.0f;
+    return glm::vec2(inverse_ * glm::vec4(ndc, 0.0f, 1.0f));
+}
+
+glm::vec2 Camera::WorldToScreen(glm::vec2 world) const
+{
+    if (dirty_)
+        Rebuild();
+    glm::vec2 ndc = glm::vec2(camera_.projection * glm::vec4(world, 0.0f, 1.0f));
+    return (ndc + 1.0f) * 0.5f * viewport_;
+}
+
+void Camera::Rebuild() const
+{
+    // World to screen: center on position, rotate the world against the camera, scale to
+    // pixels, then shake in pixels.
+    glm::vec2 half = viewport_ * 0.5f;
+    glm::mat4 projection = glm::ortho(-half.x, half.x, -half.y, half.y, -1.0f, 1.0f);
+    projection = glm::translate(projection, glm::vec3(shake_offset_, 0.0f));
+    projection = glm::scale(projection, glm::vec3(zoom_, zoom_, 1.0f));
+    projection = glm::rotate(projection, glm::radians(rotation_), glm::vec3(0.0f, 0.0f, 1.0f));
+    projection = glm::translate(projection, glm::vec3(-position_, 0.0f));
+
+    camera_.projection = projection;
+    camera_.dimensions = viewport_ / zoom_;
+    camera_.view = GetViewBounds(camera_);
+    inverse_ = glm::inverse(projection);
+    dirty_ = false;
+}
+
+} // namespace bifrost
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "bifrost.h"
+
+namespace bifrost
+{
+    // A movable 2d camera: position is the world point at the center of the viewport, zoom
+    // is pixels per world unit and rotation is degrees clockwise, like DrawRectangle. The
+    // Camera2d handed to draw calls is rebuilt, view bounds included, only when one of
+    // those changed since the last Get(), so a camera that stays put costs nothing per frame.
+    //
+    // Follow() and Shake() are eased by Update(); call it once per frame or tick before
+    // drawing. A shake offsets the picture in pixels, so it reads the same at any zoom.
+    class Camera
+    {
+    public:
+        // viewport in pixels, usually the framebuffer size.
+        explicit Camera(glm::vec2 viewport, glm::vec2 position = glm::vec2(0.0f), float zoom = 1.0f, float rotation = 0.0f);
+
+        // From the framebuffer size callback; position stays at the center.
+        void SetViewport(glm::vec2 viewport);
+        void SetPosition(glm::vec2 position);
+        void Move(glm::vec2 offset);
+        // Clamped to a small positive minimum.
+        void SetZoom(float zoom);
+        void SetRotation(float rotation);
+
+        glm::vec2 GetViewport() const { return viewport_; }
+        glm::vec2 GetPosition() const { return position_; }
+        float GetZoom() const { return zoom_; }
+        float GetRotation() const { return rotation_; }
+
+        // Eases position towards target, closing 1 - exp(-rate * dt) of the gap each Update().
+        // Movement inside dead_zone, a half size in world units around position, is ignored.
+        // Call every frame with the current target; SetPosition() stops following.
+        void Follow(glm::vec2 target, float rate = 8.0f, glm::vec2 dead_zone = glm::vec2(0.0f));
+        void StopFollowing();
+        // Shakes by up to magnitude pixels, fading out over duration seconds. A weaker shake
+        // while one is still running doesn't cut it short.
+        void Shake(float magnitude, float duration);
+        void Update(float dt);
+
+        const Camera2d& Get() const;
+        // Screen pixels from the bottom left, like InputHandler::MouseAt, to world units.
+        glm::vec2 ScreenToWorld(glm::vec2 screen) const;
+        glm::vec2 WorldToScreen(glm::vec2 world) const;
+
+    private:
+        void Rebuild() const;
+
+        glm::vec2 viewport_;
+        glm::vec2 position_;
+        float zoom_;
+        float rotation_;
+
+        bool following_ = false;
+        glm::vec2 follow_target_{0.0f};
+        float follow_rate_ = 0.0f;
+        glm::vec2 dead_zone_{0.0f};
+
+        float shake_magnitude_ = 0.0f;
+        float shake_duration_ = 0.0f;
+        float shake_left_ = 0.0f;
+        float shake_time_ = 0.0f;
+        glm::vec2 shake_offset_{0.0f};
+
+        // Rebuilt by Get() and the conversions when dirty_.
+        mutable bool dirty_ = true;
+        mutable Camera2d camera_{};
+        mutable glm::mat4 inverse_{1.0f};
+    };
+}
@@ -1,13 +1,15 @@
 #include "bifrost_collision.h"
 #include <cmath>
 #include <limits>
+#include <span>
 
 namespace
 {
 
-std::vector<glm::vec2> GetWorldVertices(const bifrost::Hitbox& h, glm::vec2 pos, float angle)
+// Both return vectors on the calling thread's frame arena; callers hold a FrameArena::Scope.
+bifrost::ArenaVector<glm::vec2> GetWorldVertices(const bifrost::Hitbox& h, glm::vec2 pos, float angle)
 {
-    std::vector<glm::vec2> verts;
+    bifrost::ArenaVector<glm::vec2> verts(&bifrost::GetFrameArena());
     verts.reserve(h.offsets.size());
     float c = std::cos(angle);
     float s = std::sin(angle);
@@ -19,9 +21,9 @@ std::vector<glm::vec2> GetWorldVertices(const bifrost::Hitbox& h, glm::vec2 pos,
     return verts;
 }
 
-std::vector<glm::vec2> GetAxes(const std::vector<glm::vec2>& verts)
+bifrost::ArenaVector<glm::vec2> GetAxes(std::span<const glm::vec2> verts)
 {
-    std::vector<glm::vec2> axes;
+    bifrost::ArenaVector<glm::vec2> axes(&bifrost::GetFrameArena());
     axes.reserve(verts.size());
     for (size_t i = 0; i < verts.size(); i++)
     {
@@ -31,7 +33,7 @@ std::vector<glm::vec2> GetAxes(const std::vector<glm::vec2>& verts)
     return axes;
 }
 
-void Project(const std::vector<glm::vec2>& verts, glm::vec2 axis, float& out_min, float& out_max)
+void Project(std::span<const glm::vec2> verts, glm::vec2 axis, float& out_min, float& out_max)
 {
     out_min = out_max = glm::dot(verts[0], axis);
     for (size_t i = 1; i < verts.size(); i++)
@@ -58,6 +60,59 @@ float SegmentIntersectT(glm::vec2 p1, glm::vec2 p2, glm::vec2 q1, glm::vec2 q2)
     return -1.0f;
 }
 
+// Small inset so a box resting flush against a wall doesn't count the wall's row/column
+// as overlapped when sliding along it.
+constexpr float tile_skin = 1e-3f;
+
+// Tile index containing coordinate v along one axis.
+int TileIndex(float v, float origin, float size)
+{
+    return (int)std::floor((v - origin) / size);
+}
+
+// How far the box [min, max] can move along axis by delta before its leading edge enters a
+// solid tile. Only the columns (or rows) between the current and target edge are visited.
+float SweepAxis(const bifrost::TileCollisionGrid& grid, int axis, glm::vec2 min, glm::vec2 max, float delta)
+{
+    if (delta == 0.0f)
+        return 0.0f;
+
+    int other = 1 - axis;
+    float origin = grid.origin[axis];
+    float size = grid.tile_size[axis];
+    int first_other = TileIndex(min[other] + tile_skin, grid.origin[other], grid.tile_size[other]);
+    int last_other = TileIndex(max[other] - tile_skin, grid.origin[other], grid.tile_size[other]);
+
+    auto line_blocked = [&](int line)
+    {
+        for (int o = first_other; o <= last_other; o++)
+        {
+            bool solid = axis == 0 ? bifrost::IsTileSolid(grid, line, o) : bifrost::IsTileSolid(grid, o, line);
+            if (solid)
+                return true;
+        }
+        return false;
+    };
+
+    if (delta > 0.0f)
+    {
+        int from = TileIndex(max[axis] - tile_skin, origin, size) + 1;
+        int to = TileIndex(max[axis] + delta - tile_skin, origin, size);
+        for (int line = from; line <= to; line++)
+            if (line_blocked(line))
+                return std::max(0.0f, origin + line * size - max[axis]);
+    }
+    else
+    {
+        int from = TileIndex(min[axis] + tile_skin, origin, size) - 1;
+        int to = TileIndex(min[axis] + delta + tile_skin, origin, size);
+        for (int line = from; line >= to; line--)
+            if (line_blocked(line))
+                return std::min(0.0f, origin + (line + 1) * size - min[axis]);
+    }
+    return delta;
+}
+
 } // anonymous namespace
 
 namespace bifrost
@@ -72,8 +127,9 @@ Hitbox GenRectHitbox(glm::vec2 size)
                    {-half.x,  half.y}}};
 }
 
-CollisionResult GetCollision(Hitbox a, glm::vec2 pos_a, float angle_a, Hitbox b, glm::vec2 pos_b, float angle_b)
+CollisionResult GetCollision(const Hitbox& a, glm::vec2 pos_a, float angle_a, const Hitbox& b, glm::vec2 pos_b, float angle_b)
 {
+    FrameArena::Scope scope(GetFrameArena());
     auto verts_a = GetWorldVertices(a, pos_a, angle_a);
     auto verts_b = GetWorldVertices(b, pos_b, angle_b);
 
@@ -83,7 +139,7 @@ CollisionResult GetCollision(Hitbox a, glm::vec2 pos_a, float angle_a, Hitbox b,
     float min_overlap = std::numeric_limits<float>::max();
     glm::vec2 mtv{};
 
-    auto test_axes = [&](const std::vector<glm::vec2>& axes) -> bool
+    auto test_axes = [&](std::span<const glm::vec2> axes) -> bool
     {
         for (const auto& axis : axes)
         {
@@ -114,13 +170,14 @@ CollisionResult GetCollision(Hitbox a, glm::vec2 pos_a, float angle_a, Hitbox b,
     return {true, mtv * min_overlap};
 }
 
-bool CheckCollision(Hitbox a, glm::vec2 pos_a, float angle_a, Hitbox b, glm::vec2 pos_b, float angle_b)
+bool CheckCollision(const Hitbox& a, glm::vec2 pos_a, float angle_a, const Hitbox& b, glm::vec2 pos_b, float angle_b)
 {
     return GetCollision(a, pos_a, angle_a, b, pos_b, angle_b).hit;
 }
 
-bool ContainsPoint(Hitbox h, glm::vec2 pos, float angle, glm::vec2 point)
+bool ContainsPoint(const Hitbox& h, glm::vec2 pos, float angle, glm::vec2 point)
 {
+    FrameArena::Scope scope(GetFrameArena());
     auto verts = GetWorldVertices(h, pos, angle);
     auto axes = GetAxes(verts);
 
@@ -135,8 +192,9 @@ bool ContainsPoint(Hitbox h, glm::vec2 pos, float angle, glm::vec2 point)
     return true;
 }
 
-LineIntersectionResult GetLineIntersection(Hitbox h, glm::vec2 pos, float angle, glm::vec2 line_start, glm::vec2 line_end)
+LineIntersectionResult GetLineIntersection(const Hitbox& h, glm::vec2 pos, float angle, glm::vec2 line_start, glm::vec2 line_end)
 {
+    FrameArena::Scope scope(GetFrameArena());
     auto verts = GetWorldVertices(h, pos, angle);
 
     float best_t = std::numeric_limits<float>::max();
@@ -161,21 +219,140 @@ LineIntersectionResult GetLineIntersection(Hitbox h, glm::vec2 pos, float angle,
     return {false, {}, {}};
 }
 
-bool CheckLineIntersection(Hitbox h, glm::vec2 pos, float angle, glm::vec2 line_start, glm::vec2 line_end)
+bool CheckLineIntersection(const Hitbox& h, glm::vec2 pos, float angle, glm::vec2 line_start, glm::vec2 line_end)
 {
     return GetLineIntersection(h, pos, angle, line_start, line_end).hit;
 }
 
-void DrawHitbox(Camera2d camera, Hitbox hitbox, glm::vec2 pos, float angle, glm::vec3 color)
+void DrawHitbox(Camera2d camera, const Hitbox& hitbox, glm::vec2 pos, float angle, glm::vec3 color)
 {
     return DrawHitbox(camera, hitbox, pos, angle, glm::vec4(color, 1.0f));
 }
 
-void DrawHitbox(Camera2d camera, Hitbox hitbox, glm::vec2 pos, float angle, glm::vec4 color)
+void DrawHitbox(Camera2d camera, const Hitbox& hitbox, glm::vec2 pos, float angle, glm::vec4 color)
 {
+    FrameArena::Scope scope(GetFrameArena());
     auto verts = GetWorldVertices(hitbox, pos, angle);
     for (size_t i = 0; i < verts.size(); i++)
         DrawLine(camera, verts[i], verts[(i + 1) % verts.size()], 1.0f, color);
 }
 
+TileCollisionGrid GenTileCollisionGrid(int width, int height, glm::vec2 tile_size, glm::vec2 origin)
+{
+    TileCollisionGrid grid = {};
+    grid.width = width;
+    grid.height = height;
+    grid.origin = origin;
+    grid.tile_size = tile_size;
+    grid.solid.assign(((size_t)width * height + 63) / 64, 0);
+    return grid;
+}
+
+TileCollisionGrid GenTileCollisionGrid(int width, int height, glm::vec2 tile_size, glm::vec2 origin, FunctionRef<bool(int, int)> is_solid)
+{
+    auto grid = GenTileCollisionGrid(width, height, tile_size, origin);
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            if (is_solid(x, y))
+                SetTileSolid(grid, x, y, true);
+    return grid;
+}
+
+bool IsTileSolid(const TileCollisionGrid& grid, int x, int y)
+{
+    if (x < 0 || y < 0 || x >= grid.width || y >= grid.height)
+        return true;
+    size_t bit = (size_t)y * grid.width + x;
+    return (grid.solid[bit >> 6] >> (bit & 63)) & 1;
+}
+
+void SetTileSolid(TileCollisionGrid& grid, int x, int y, bool solid)
+{
+    if (x < 0 || y < 0 || x >= grid.width || y >= grid.height)
+        return;
+    size_t bit = (size_t)y * grid.width + x;
+    if (solid)
+        grid.solid[bit >> 6] |= (uint64_t)1 << (bit & 63);
+    else
+        grid.solid[bit >> 6] &= ~((uint64_t)1 << (bit & 63));
+}
+
+CollisionResult GetCollision(const TileCollisionGrid& grid, glm::vec2 pos, glm::vec2 size, glm::vec2 delta)
+{
+    glm::vec2 half = size * 0.5f;
+    glm::vec2 min = pos - half;
+    glm::vec2 max = pos + half;
+
+    float dx = SweepAxis(grid, 0, min, max, delta.x);
+    min.x += dx;
+    max.x += dx;
+    float dy = SweepAxis(grid, 1, min, max, delta.y);
+
+    glm::vec2 penetration = glm::vec2(dx, dy) - delta;
+    return {penetration != glm::vec2(0.0f), penetration};
+}
+
+LineIntersectionResult GetLineIntersection(const TileCollisionGrid& grid, glm::vec2 line_start, glm::vec2 line_end)
+{
+    glm::vec2 d = line_end - line_start;
+    glm::vec2 local = (line_start - grid.origin) / grid.tile_size;
+    glm::ivec2 cell = glm::ivec2((int)std::floor(local.x), (int)std::floor(local.y));
+
+    if (IsTileSolid(grid, cell.x, cell.y))
+        return {true, line_start, {}};
+
+    const float inf = std::numeric_limits<float>::infinity();
+    glm::ivec2 step = glm::ivec2(d.x > 0.0f ? 1 : (d.x < 0.0f ? -1 : 0), d.y > 0.0f ? 1 : (d.y < 0.0f ? -1 : 0));
+    glm::vec2 t_delta = glm::vec2(step.x ? grid.tile_size.x / std::abs(d.x) : inf,
+                                  step.y ? grid.tile_size.y / std::abs(d.y) : inf);
+
+    // Parametric distance along the line to the first vertical / horizontal tile boundary.
+    glm::vec2 t_max = glm::vec2(inf);
+    for (int axis = 0; axis < 2; axis++)
+    {
+        if (!step[axis])
+            continue;
+        float boundary = grid.origin[axis] + (cell[axis] + (step[axis] > 0 ? 1 : 0)) * grid.tile_size[axis];
+        t_max[axis] = (boundary - line_start[axis]) / d[axis];
+    }
+
+    while (true)
+    {
+        float t;
+        glm::vec2 normal{};
+        if (t_max.x < t_max.y)
+        {
+            t = t_max.x;
+            cell.x += step.x;
+            t_max.x += t_delta.x;
+            normal = glm::vec2((float)-step.x, 0.0f);
+        }
+        else
+        {
+            t = t_max.y;
+            cell.y += step.y;
+            t_max.y += t_delta.y;
+            normal = glm::vec2(0.0f, (float)-step.y);
+        }
+
+        if (t > 1.0f)
+            break;
+
+        if (IsTileSolid(grid, cell.x, cell.y))
+            return {true, line_start + t * d, normal};
+    }
+
+    return {false, {}, {}};
+}
+
+bool CheckLineIntersection(const TileCollisionGrid& grid, glm::vec2 line_start, glm::vec2 line_end)
+{
+    return GetLineIntersection(grid, line_start, line_end).hit;
+}
+
+bool HasLineOfSight(const TileCollisionGrid& grid, glm::vec2 from, glm::vec2 to)
+{
+    return !CheckLineIntersection(grid, from, to);
+}
+
 } // namespace bifrost
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "bifrost.h"
+#include "bifrost_arena.h"
+#include <cstdint>
 #include <vector>
 
 namespace bifrost
@@ -25,12 +27,39 @@ namespace bifrost
 
     Hitbox GenRectHitbox(glm::vec2 size);
 
-    bool CheckCollision(Hitbox a, glm::vec2 pos_a, float angle_a, Hitbox b, glm::vec2 pos_b, float angle_b);
-    CollisionResult GetCollision(Hitbox a, glm::vec2 pos_a, float angle_a, Hitbox b, glm::vec2 pos_b, float angle_b);
-    bool CheckLineIntersection(Hitbox h, glm::vec2 pos, float angle, glm::vec2 line_start, glm::vec2 line_end);
-    LineIntersectionResult GetLineIntersection(Hitbox h, glm::vec2 pos, float angle, glm::vec2 line_start, glm::vec2 line_end);
-    bool ContainsPoint(Hitbox h, glm::vec2 pos, float angle, glm::vec2 point);
+    bool CheckCollision(const Hitbox& a, glm::vec2 pos_a, float angle_a, const Hitbox& b, glm::vec2 pos_b, float angle_b);
+    CollisionResult GetCollision(const Hitbox& a, glm::vec2 pos_a, float angle_a, const Hitbox& b, glm::vec2 pos_b, float angle_b);
+    bool CheckLineIntersection(const Hitbox& h, glm::vec2 pos, float angle, glm::vec2 line_start, glm::vec2 line_end);
+    LineIntersectionResult GetLineIntersection(const Hitbox& h, glm::vec2 pos, float angle, glm::vec2 line_start, glm::vec2 line_end);
+    bool ContainsPoint(const Hitbox& h, glm::vec2 pos, float angle, glm::vec2 point);
 
-    void DrawHitbox(Camera2d camera, Hitbox hitbox, glm::vec2 pos, float angle, glm::vec3 color);
-    void DrawHitbox(Camera2d camera, Hitbox hitbox, glm::vec2 pos, float angle, glm::vec4 color);
+    void DrawHitbox(Camera2d camera, const Hitbox& hitbox, glm::vec2 pos, float angle, glm::vec3 color);
+    void DrawHitbox(Camera2d camera, const Hitbox& hitbox, glm::vec2 pos, float angle, glm::vec4 color);
+
+    // Static world collision for tile maps: one bit per tile, tile (0, 0) has its lower-left
+    // corner at origin. Queries walk only the cells they pass through, so cost depends on
+    // distance moved rather than on how many walls the map has. Cells outside the grid are solid.
+    struct TileCollisionGrid
+    {
+        int width;
+        int height;
+        glm::vec2 origin;
+        glm::vec2 tile_size;
+        std::vector<uint64_t> solid;
+    };
+
+    TileCollisionGrid GenTileCollisionGrid(int width, int height, glm::vec2 tile_size, glm::vec2 origin = glm::vec2(0.0f));
+    TileCollisionGrid GenTileCollisionGrid(int width, int height, glm::vec2 tile_size, glm::vec2 origin, FunctionRef<bool(int, int)> is_solid);
+    bool IsTileSolid(const TileCollisionGrid& grid, int x, int y);
+    void SetTileSolid(TileCollisionGrid& grid, int x, int y, bool solid);
+
+    // Sweeps an axis-aligned box centered at pos by delta, one axis at a time, stopping at the
+    // first solid tile. pos + delta + penetration is the resolved position, so the result can be
+    // applied the same way as GetCollision's.
+    CollisionResult GetCollision(const TileCollisionGrid& grid, glm::vec2 pos, glm::vec2 size, glm::vec2 delta);
+
+    // Amanatides-Woo grid traversal; normal is that of the tile face the line entered through.
+    bool CheckLineIntersection(const TileCollisionGrid& grid, glm::vec2 line_start, glm::vec2 line_end);
+    LineIntersectionResult GetLineIntersection(const TileCollisionGrid& grid, glm::vec2 line_start, glm::vec2 line_end);
+    bool HasLineOfSight(const TileCollisionGrid& grid, glm::vec2 from, glm::vec2 to);
 }
@@ -1,14 +1,355 @@
 #include "bifrost_dungeon.h"
+#include "bifrost_jobs.h"
+
+#include <algorithm>
+#include <limits>
 
 namespace
 {
 
 #include "tilemap_png.h"
 
+struct BspNode
+{
+    glm::ivec4 rect;     // x, y, width, height
+    int children[2];     // -1 for leaves
+    glm::ivec2 anchor;   // a floor cell inside this subtree, used to route corridors
+};
+
+// Same Lehmer generator as bifrost::Random, but with local state so regions can be carved
+// on any thread in any order and still produce the same map.
+uint32_t NextRandom(uint32_t& state)
+{
+    state = (uint32_t)(((uint64_t)state * 48271) % 0x7fffffff);
+    return state;
+}
+
+float NextRandomFloat(uint32_t& state)
+{
+    return (float)NextRandom(state) / (float)0x7fffffff;
+}
+
+int NextRandomRange(uint32_t& state, int min, int max)
+{
+    if (max <= min)
+        return min;
+    return min + (int)(NextRandom(state) % (uint32_t)(max - min + 1));
+}
+
+uint32_t HashSeed(uint32_t seed, uint32_t index)
+{
+    uint32_t h = seed ^ (index * 0x9e3779b9u);
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    h %= 0x7fffffff;
+    return h ? h : 0x45;
+}
+
+// Runs fn(begin, end) over [0, count) on the shared job system.
+template <typename F>
+void ParallelRange(int count, int min_chunk, F&& fn)
+{
+    bifrost::GetJobSystem().ParallelFor((size_t)count, [&fn](size_t begin, size_t end) { fn((int)begin, (int)end); }, (size_t)min_chunk);
+}
+
+void SplitBsp(std::vector<BspNode>& nodes, int index, int min_leaf, uint32_t& rng)
+{
+    glm::ivec4 rect = nodes[index].rect;
+    bool can_split_x = rect.z >= min_leaf * 2;
+    bool can_split_y = rect.w >= min_leaf * 2;
+    if (!can_split_x && !can_split_y)
+        return;
+
+    bool split_x = can_split_x && (!can_split_y || rect.z > rect.w || (rect.z == rect.w && NextRandom(rng) & 1));
+
+    glm::ivec4 a = rect;
+    glm::ivec4 b = rect;
+    if (split_x)
+    {
+        int at = NextRandomRange(rng, min_leaf, rect.z - min_leaf);
+        a.z = at;
+        b.x += at;
+        b.z -= at;
+    }
+    else
+    {
+        int at = NextRandomRange(rng, min_leaf, rect.w - min_leaf);
+        a.w = at;
+        b.y += at;
+        b.w -= at;
+    }
+
+    int left = (int)nodes.size();
+    nodes.push_back({a, {-1, -1}, {}});
+    nodes.push_back({b, {-1, -1}, {}});
+    nodes[index].children[0] = left;
+    nodes[index].children[1] = left + 1;
+
+    SplitBsp(nodes, left, min_leaf, rng);
+    SplitBsp(nodes, left + 1, min_leaf, rng);
+}
+
+void CarveRoom(bifrost::DungeonMap& map, BspNode& leaf, const bifrost::DungeonParams& params, uint32_t& rng)
+{
+    glm::ivec4 r = leaf.rect;
+    int max_w = r.z - 2;
+    int max_h = r.w - 2;
+    int w = NextRandomRange(rng, std::min(params.min_room_size, max_w), max_w);
+    int h = NextRandomRange(rng, std::min(params.min_room_size, max_h), max_h);
+    int x = NextRandomRange(rng, r.x + 1, r.x + r.z - 1 - w);
+    int y = NextRandomRange(rng, r.y + 1, r.y + r.w - 1 - h);
+
+    for (int j = y; j < y + h; j++)
+        std::fill_n(&map.cells[(size_t)j * map.width + x], w, bifrost::DungeonCell::Floor);
+
+    leaf.anchor = glm::ivec2(x + w / 2, y + h / 2);
+}
+
+// Cellular-automata cave inside the leaf (1 cell margin). Only the largest connected
+// pocket is kept so the corridor anchor reaches all of it. Returns false if the cave
+// collapsed and the caller should fall back to a room.
+bool CarveCave(bifrost::DungeonMap& map, BspNode& leaf, const bifrost::DungeonParams& params, uint32_t& rng)
+{
+    int w = leaf.rect.z - 2;
+    int h = leaf.rect.w - 2;
+    int ox = leaf.rect.x + 1;
+    int oy = leaf.rect.y + 1;
+
+    std::vector<uint8_t> solid((size_t)w * h);
+    std::vector<uint8_t> next((size_t)w * h);
+    for (auto& s : solid)
+        s = NextRandomFloat(rng) < params.cave_fill;
+
+    auto is_solid = [&](int x, int y) -> int
+    {
+        if (x < 0 || y < 0 || x >= w || y >= h)
+            return 1;
+        return solid[(size_t)y * w + x];
+    };
+
+    for (int iteration = 0; iteration < params.cave_iterations; iteration++)
+    {
+        for (int y = 0; y < h; y++)
+        {
+            for (int x = 0; x < w; x++)
+            {
+                int neighbours = is_solid(x - 1, y - 1) + is_solid(x, y - 1) + is_solid(x + 1, y - 1)
+                               + is_solid(x - 1, y)                          + is_solid(x + 1, y)
+                               + is_solid(x - 1, y + 1) + is_solid(x, y + 1) + is_solid(x + 1, y + 1);
+                next[(size_t)y * w + x] = neighbours >= 5 || (neighbours == 4 && solid[(size_t)y * w + x]);
+            }
+        }
+        std::swap(solid, next);
+    }
+
+    // Flood fill to find the largest open pocket; next[] is reused as the region label.
+    std::fill(next.begin(), next.end(), 0);
+    std::vector<int> stack{};
+    std::vector<int> best{};
+    std::vector<int> region{};
+    for (int start = 0; start < w * h; start++)
+    {
+        if (solid[start] || next[start])
+            continue;
+
+        region.clear();
+        stack.push_back(start);
+        next[start] = 1;
+        while (!stack.empty())
+        {
+            int i = stack.back();
+            stack.pop_back();
+            region.push_back(i);
+            int x = i % w;
+            int y = i / w;
+            const int neighbours[4][2] = {{x - 1, y}, {x + 1, y}, {x, y - 1}, {x, y + 1}};
+            for (const auto& n : neighbours)
+            {
+                if (n[0] < 0 || n[1] < 0 || n[0] >= w || n[1] >= h)
+                    continue;
+                int ni = n[1] * w + n[0];
+                if (solid[ni] || next[ni])
+                    continue;
+                next[ni] = 1;
+                stack.push_back(ni);
+            }
+        }
+        if (region.size() > best.size())
+            std::swap(region, best);
+    }
+
+    if ((int)best.size() < params.min_room_size * params.min_room_size)
+        return false;
+
+    glm::vec2 centroid{0.0f};
+    for (int i : best)
+    {
+        map.cells[(size_t)(oy + i / w) * map.width + ox + i % w] = bifrost::DungeonCell::Floor;
+        centroid += glm::vec2((float)(i % w), (float)(i / w));
+    }
+    centroid /= (float)best.size();
+
+    int anchor = best[0];
+    float best_distance = std::numeric_limits<float>::max();
+    for (int i : best)
+    {
+        glm::vec2 d = glm::vec2((float)(i % w), (float)(i / w)) - centroid;
+        float distance = glm::dot(d, d);
+        if (distance < best_distance)
+        {
+            best_distance = distance;
+            anchor = i;
+        }
+    }
+    leaf.anchor = glm::ivec2(ox + anchor % w, oy + anchor / w);
+    return true;
+}
+
+void CarveCorridor(bifrost::DungeonMap& map, glm::ivec2 from, glm::ivec2 to, bool horizontal_first)
+{
+    auto carve = [&map](int x, int y)
+    {
+        auto& cell = map.cells[(size_t)y * map.width + x];
+        if (cell == bifrost::DungeonCell::Rock)
+            cell = bifrost::DungeonCell::Floor;
+    };
+
+    glm::ivec2 corner = horizontal_first ? glm::ivec2(to.x, from.y) : glm::ivec2(from.x, to.y);
+    for (int x = std::min(from.x, corner.x); x <= std::max(from.x, corner.x); x++)
+        carve(x, horizontal_first ? from.y : to.y);
+    for (int y = std::min(from.y, to.y); y <= std::max(from.y, to.y); y++)
+        carve(corner.x, y);
+    for (int x = std::min(corner.x, to.x); x <= std::max(corner.x, to.x); x++)
+        carve(x, to.y);
 }
 
+} // anonymous namespace
+
 bifrost::Texture bifrost::GetDungeonTexture()
 {
     return bifrost::LoadTexture(tilemap_png, static_cast<int>(tilemap_png_len));
 }
 
+bifrost::Tileset bifrost::GetDungeonTileset()
+{
+    return bifrost::GenTileset(GetDungeonTexture(), glm::vec2(16.0f), glm::vec2(17.0f));
+}
+
+bifrost::DungeonMap bifrost::GenDungeon(const DungeonParams& params)
+{
+    DungeonMap map = {};
+    map.width = params.width;
+    map.height = params.height;
+    map.cells.assign((size_t)map.width * map.height, DungeonCell::Rock);
+
+    // One draw from the global generator; everything else derives from it so the result
+    // doesn't depend on thread scheduling.
+    uint32_t root_seed = bifrost::Random();
+    uint32_t rng = HashSeed(root_seed, 0);
+
+    int min_leaf = std::max(params.min_leaf_size, params.min_room_size + 2);
+    std::vector<BspNode> nodes{};
+    nodes.reserve((size_t)(map.width / min_leaf + 1) * (map.height / min_leaf + 1) * 2);
+    nodes.push_back({{0, 0, map.width, map.height}, {-1, -1}, {}});
+    SplitBsp(nodes, 0, min_leaf, rng);
+
+    std::vector<int> leaves{};
+    for (int i = 0; i < (int)nodes.size(); i++)
+        if (nodes[i].children[0] < 0)
+            leaves.push_back(i);
+
+    // Leaves never overlap, so each one can be carved independently.
+    ParallelRange((int)leaves.size(), 4, [&](int begin, int end)
+    {
+        for (int l = begin; l < end; l++)
+        {
+            auto& leaf = nodes[leaves[l]];
+            uint32_t leaf_rng = HashSeed(root_seed, (uint32_t)leaves[l] + 1);
+            bool cave = NextRandomFloat(leaf_rng) < params.cave_chance;
+            if (!cave || !CarveCave(map, leaf, params, leaf_rng))
+                CarveRoom(map, leaf, params, leaf_rng);
+        }
+    });
+
+    for (int l : leaves)
+        map.regions.push_back(nodes[l].rect);
+
+    // Children always come after their parent, so walking backwards joins the deepest
+    // siblings first and hands an anchor up to the parent.
+    for (int i = (int)nodes.size() - 1; i >= 0; i--)
+    {
+        auto& node = nodes[i];
+        if (node.children[0] < 0)
+            continue;
+
+        const auto& a = nodes[node.children[0]];
+        const auto& b = nodes[node.children[1]];
+        CarveCorridor(map, a.anchor, b.anchor, NextRandom(rng) & 1);
+        node.anchor = (NextRandom(rng) & 1) ? a.anchor : b.anchor;
+    }
+
+    // Any rock touching floor (including diagonally) becomes wall. Reads come from the
+    // carved cells and writes go to a copy so rows can be processed in parallel.
+    std::vector<DungeonCell> walled = map.cells;
+    ParallelRange(map.height, 16, [&](int begin, int end)
+    {
+        for (int y = begin; y < end; y++)
+        {
+            for (int x = 0; x < map.width; x++)
+            {
+                if (map.cells[(size_t)y * map.width + x] != DungeonCell::Rock)
+                    continue;
+
+                bool touches_floor = false;
+                for (int dy = -1; dy <= 1 && !touches_floor; dy++)
+                {
+                    int ny = y + dy;
+                    if (ny < 0 || ny >= map.height)
+                        continue;
+                    for (int dx = -1; dx <= 1; dx++)
+                    {
+                        int nx = x + dx;
+                        if (nx >= 0 && nx < map.width && map.cells[(size_t)ny * map.width + nx] == DungeonCell::Floor)
+                        {
+                            touches_floor = true;
+                            break;
+                        }
+                    }
+                }
+                if (touches_floor)
+                    walled[(size_t)y * map.width + x] = DungeonCell::Wall;
+            }
+        }
+    });
+    map.cells = std::move(walled);
+
+    return map;
+}
+
+bifrost::DungeonCell bifrost::GetDungeonCell(const DungeonMap& map, int x, int y)
+{
+    if (x < 0 || y < 0 || x >= map.width || y >= map.height)
+        return DungeonCell::Rock;
+    return map.cells[(size_t)y * map.width + x];
+}
+
+bool bifrost::IsDungeonCellSolid(DungeonCell cell)
+{
+    return cell != DungeonCell::Floor;
+}
+
+std::vector<uint16_t> bifrost::GetDungeonTiles(const DungeonMap& map, uint16_t floor_tile, uint16_t wall_tile)
+{
+    std::vector<uint16_t> tiles(map.cells.size(), EMPTY_TILE);
+    for (size_t i = 0; i < map.cells.size(); i++)
+    {
+        if (map.cells[i] == DungeonCell::Floor)
+            tiles[i] = floor_tile;
+        else if (map.cells[i] == DungeonCell::Wall)
+            tiles[i] = wall_tile;
+    }
+    return tiles;
+}
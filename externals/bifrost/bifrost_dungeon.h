@@ -1,9 +1,54 @@
 #pragma once
 
 #include "bifrost.h"
+#include "bifrost_tilemap.h"
+
+#include <cstdint>
+#include <vector>
 
 namespace bifrost
 {
     bifrost::Texture GetDungeonTexture();
+
+    // The dungeon atlas: 12x11 tiles of 16x16 px with 1px gaps (17px stride).
+    bifrost::Tileset GetDungeonTileset();
+
+    enum class DungeonCell : uint8_t
+    {
+        Rock,
+        Floor,
+        Wall,
+    };
+
+    struct DungeonParams
+    {
+        int width = 128;
+        int height = 128;
+        int min_leaf_size = 12;     // BSP regions are not split below this size
+        int min_room_size = 4;
+        float cave_chance = 0.3f;   // fraction of regions carved as caves instead of rooms
+        float cave_fill = 0.45f;    // initial rock density of a cave region
+        int cave_iterations = 4;
+    };
+
+    struct DungeonMap
+    {
+        int width;
+        int height;
+        std::vector<DungeonCell> cells;
+        std::vector<glm::ivec4> regions;  // x, y, width, height of every carved BSP region
+    };
+
+    // Generates a connected dungeon: the map is split with BSP, every region is carved as a
+    // room or a cellular-automata cave, and sibling regions are joined by corridors. Output is
+    // deterministic for a given bifrost::Seed() and params, independent of how many threads
+    // carve the regions.
+    DungeonMap GenDungeon(const DungeonParams& params);
+
+    DungeonCell GetDungeonCell(const DungeonMap& map, int x, int y);
+    bool IsDungeonCellSolid(DungeonCell cell);
+
+    // Tile indices for a Tilemap of the same size; rock becomes EMPTY_TILE.
+    std::vector<uint16_t> GetDungeonTiles(const DungeonMap& map, uint16_t floor_tile, uint16_t wall_tile);
 }
 
@@ -0,0 +1,263 @@
+#include "bifrost_ecs.h"
+
+#include <array>
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+namespace
+{
+
+// Fixed size so lookups need no lock while another thread registers a type.
+std::mutex component_mutex{};
+std::array<bifrost::ComponentInfo, bifrost::MAX_COMPONENTS> components{};
+uint32_t component_count = 0;
+
+std::byte* AllocateColumn(const bifrost::ComponentInfo& info, size_t capacity)
+{
+    return static_cast<std::byte*>(::operator new(info.size * capacity, std::align_val_t(info.alignment)));
+}
+
+void FreeColumn(const bifrost::ComponentInfo& info, std::byte* data)
+{
+    ::operator delete(data, std::align_val_t(info.alignment));
+}
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+ComponentId RegisterComponent(const ComponentInfo& info)
+{
+    std::lock_guard lock(component_mutex);
+    if (component_count >= MAX_COMPONENTS)
+    {
+        fprintf(stderr, "bifrost: more than %u component types\n", MAX_COMPONENTS);
+        abort();
+    }
+    components[component_count] = info;
+    return component_count++;
+}
+
+const ComponentInfo& GetComponentInfo(ComponentId id)
+{
+    return components[id];
+}
+
+World::World(JobSystem* jobs)
+    : jobs_(jobs ? jobs : &GetJobSystem())
+{
+    GetArchetype(0);
+}
+
+World::~World()
+{
+    for (auto& archetype : archetypes_)
+    {
+        for (Column& column : archetype->columns)
+        {
+            const ComponentInfo& info = GetComponentInfo(column.component);
+            for (size_t row = 0; row < archetype->entities.size(); row++)
+                info.destroy(column.data + row * info.size);
+            FreeColumn(info, column.data);
+        }
+    }
+}
+
+Entity World::Create()
+{
+    return CreateIn(0);
+}
+
+Entity World::CreateIn(ComponentMask mask)
+{
+    uint32_t index;
+    if (!free_records_.empty())
+    {
+        index = free_records_.back();
+        free_records_.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)records_.size();
+        records_.push_back(Record{NO_ARCHETYPE, 0, 0});
+    }
+
+    Entity entity{index, records_[index].generation};
+    uint32_t archetype = GetArchetype(mask);
+    records_[index].archetype = archetype;
+    records_[index].row = AddRow(*archetypes_[archetype], entity);
+    size_++;
+    return entity;
+}
+
+void World::Destroy(Entity entity)
+{
+    if (!IsAlive(entity))
+        return;
+
+    Record& record = records_[entity.index];
+    Archetype& archetype = *archetypes_[record.archetype];
+    for (Column& column : archetype.columns)
+    {
+        const ComponentInfo& info = GetComponentInfo(column.component);
+        info.destroy(column.data + record.row * info.size);
+    }
+    RemoveRow(archetype, record.row);
+
+    record.archetype = NO_ARCHETYPE;
+    record.generation++;
+    free_records_.push_back(entity.index);
+    size_--;
+}
+
+bool World::IsAlive(Entity entity) const
+{
+    return entity.index < records_.size() && records_[entity.index].generation == entity.generation &&
+           records_[entity.index].archetype != NO_ARCHETYPE;
+}
+
+void World::Move(Entity entity, ComponentMask mask)
+{
+    Record& record = records_[entity.index];
+    uint32_t target_index = GetArchetype(mask);
+    Archetype& source = *archetypes_[record.archetype];
+    Archetype& target = *archetypes_[target_index];
+
+    uint32_t row = AddRow(target, entity);
+    for (Column& column : source.columns)
+    {
+        const ComponentInfo& info = GetComponentInfo(column.component);
+        std::byte* component = column.data + record.row * info.size;
+        if (target.Has(column.component))
+            info.relocate(target.columns[target.column_of[column.component]].data + row * info.size, component);
+        else
+            info.destroy(component);
+    }
+    RemoveRow(source, record.row);
+
+    record.archetype = target_index;
+    record.row = row;
+}
+
+uint32_t World::GetArchetype(ComponentMask mask)
+{
+    auto it = archetype_of_mask_.find(mask);
+    if (it != archetype_of_mask_.end())
+        return it->second;
+
+    auto archetype = std::make_unique<Archetype>();
+    archetype->mask = mask;
+    archetype->column_of.fill(-1);
+    for (ComponentMask bits = mask; bits; bits &= bits - 1)
+    {
+        ComponentId id = (ComponentId)std::countr_zero(bits);
+        archetype->column_of[id] = (int8_t)archetype->columns.size();
+        archetype->columns.push_back(Column{id, nullptr});
+    }
+
+    uint32_t index = (uint32_t)archetypes_.size();
+    archetypes_.push_back(std::move(archetype));
+    archetype_of_mask_[mask] = index;
+    return index;
+}
+
+uint32_t World::AddRow(Archetype& archetype, Entity entity)
+{
+    size_t row = archetype.entities.size();
+    if (row == archetype.capacity)
+    {
+        size_t capacity = std::max<size_t>(archetype.capacity * 2, 64);
+        for (Column& column : archetype.columns)
+        {
+            const ComponentInfo& info = GetComponentInfo(column.component);
+            std::byte* data = AllocateColumn(info, capacity);
+            for (size_t i = 0; i < row; i++)
+                info.relocate(data + i * info.size, column.data + i * info.size);
+            if (column.data)
+                FreeColumn(info, column.data);
+            column.data = data;
+        }
+        archetype.capacity = capacity;
+    }
+    archetype.entities.push_back(entity);
+    return (uint32_t)row;
+}
+
+void World::RemoveRow(Archetype& archetype, uint32_t row)
+{
+    size_t last = archetype.entities.size() - 1;
+    if (row != last)
+    {
+        for (Column& column : archetype.columns)
+        {
+            const ComponentInfo& info = GetComponentInfo(column.component);
+            info.relocate(column.data + row * info.size, column.data + last * info.size);
+        }
+        Entity moved = archetype.entities[last];
+        archetype.entities[row] = moved;
+        records_[moved.index].row = row;
+    }
+    archetype.entities.pop_back();
+}
+
+const std::vector<uint32_t>& World::Query(ComponentMask mask)
+{
+    QueryCache& query = queries_[mask];
+    for (; query.checked < archetypes_.size(); query.checked++)
+    {
+        if ((archetypes_[query.checked]->mask & mask) == mask)
+            query.archetypes.push_back((uint32_t)query.checked);
+    }
+    return query.archetypes;
+}
+
+void DrawSprites(World& world, RenderQueue& queue)
+{
+    world.ParallelForEach<Transform, Sprite>([&queue](const Transform& transform, const Sprite& sprite)
+    {
+        if (sprite.texture.id == 0)
+        {
+            queue.DrawRectangle(sprite.layer, transform.position, sprite.size, transform.angle, sprite.color);
+            return;
+        }
+        glm::vec2 source_size = sprite.source_size;
+        if (source_size == glm::vec2(0.0f))
+            source_size = glm::vec2((float)sprite.texture.width, (float)sprite.texture.height);
+        queue.DrawRectangle(sprite.layer, transform.position, sprite.size, transform.angle, sprite.texture, sprite.source_origin,
+                            source_size, sprite.color);
+    });
+}
+
+void DrawHitboxes(World& world, Camera2d camera, glm::vec4 color)
+{
+    world.ForEach<Transform, Hitbox>([&](const Transform& transform, const Hitbox& hitbox)
+    {
+        DrawHitbox(camera, hitbox, transform.position, -glm::radians(transform.angle), color);
+    });
+}
+
+void ForEachCollision(World& world, Entity entity, FunctionRef<void(Entity, const CollisionResult&)> fn)
+{
+    const Transform* transform = world.Get<Transform>(entity);
+    const Hitbox* hitbox = world.Get<Hitbox>(entity);
+    if (!transform || !hitbox)
+        return;
+
+    // Collision angles are counter-clockwise radians.
+    glm::vec2 position = transform->position;
+    float angle = -glm::radians(transform->angle);
+    world.ForEach<Transform, Hitbox>([&](Entity other, const Transform& other_transform, const Hitbox& other_hitbox)
+    {
+        if (other == entity)
+            return;
+        CollisionResult result = GetCollision(*hitbox, position, angle, other_hitbox, other_transform.position,
+                                              -glm::radians(other_transform.angle));
+        if (result.hit)
+            fn(other, result);
+    });
+}
+
+} // namespace bifrost
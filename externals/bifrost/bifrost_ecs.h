@@ -0,0 +1,283 @@
+#pragma once
+
+#include "bifrost.h"
+#include "bifrost_arena.h"
+#include "bifrost_collision.h"
+#include "bifrost_jobs.h"
+#include "bifrost_render.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace bifrost
+{
+    struct Entity
+    {
+        uint32_t index;
+        uint32_t generation;
+
+        bool operator==(const Entity&) const = default;
+    };
+
+    using ComponentId = uint32_t;
+    using ComponentMask = uint64_t;
+    constexpr ComponentId MAX_COMPONENTS = 64;
+
+    // What a World needs to move and destroy a component without knowing its type.
+    struct ComponentInfo
+    {
+        size_t size;
+        size_t alignment;
+        void (*relocate)(void* destination, void* source);  // move constructs, then destroys source
+        void (*destroy)(void* component);
+    };
+
+    // Ids are handed out the first time each type is used, shared by every World.
+    ComponentId RegisterComponent(const ComponentInfo& info);
+    const ComponentInfo& GetComponentInfo(ComponentId id);
+
+    template<typename T>
+    ComponentId GetComponentId()
+    {
+        static const ComponentId id = RegisterComponent(ComponentInfo{sizeof(T), alignof(T),
+            [](void* destination, void* source)
+            {
+                new (destination) T(std::move(*static_cast<T*>(source)));
+                static_cast<T*>(source)->~T();
+            },
+            [](void* component) { static_cast<T*>(component)->~T(); }});
+        return id;
+    }
+
+    template<typename... Ts>
+    ComponentMask GetComponentMask()
+    {
+        return (ComponentMask(0) | ... | (ComponentMask(1) << GetComponentId<Ts>()));
+    }
+
+    // Built-in components, drawn by DrawSprites() and tested by ForEachCollision(). Hitbox
+    // from bifrost_collision.h is the third; its offsets are relative to the Transform.
+    struct Transform
+    {
+        glm::vec2 position{0.0f};
+        float angle = 0.0f;             // degrees clockwise, like DrawRectangle
+    };
+
+    struct Sprite
+    {
+        glm::vec2 size{1.0f};
+        glm::vec4 color{1.0f};
+        Texture texture{};              // zero draws a solid rectangle
+        glm::vec2 source_origin{0.0f};
+        glm::vec2 source_size{0.0f};    // zero is the whole texture
+        int layer = 0;
+    };
+
+    // Archetype entity store: every distinct set of component types gets an archetype that
+    // keeps each component in its own contiguous column, one row per entity, so iterating
+    // a few components of many entities walks a few flat arrays. Adding or removing a
+    // component moves the entity's row to another archetype; destroying one moves the last
+    // row into the gap. Queries remember which archetypes match and only check archetypes
+    // created since their last use.
+    //
+    // Not thread safe. Don't create, destroy, add or remove inside ForEach(); collect the
+    // entities and change them afterwards. ParallelForEach() calls fn from several job
+    // threads at once, each with different entities.
+    class World
+    {
+    public:
+        // Null uses GetJobSystem().
+        explicit World(JobSystem* jobs = nullptr);
+        ~World();
+
+        World(const World&) = delete;
+        World& operator=(const World&) = delete;
+
+        Entity Create();
+
+        template<typename... Ts>
+        Entity Create(Ts&&... components)
+        {
+            Entity entity = CreateIn(GetComponentMask<std::remove_cvref_t<Ts>...>());
+            const Record& record = records_[entity.index];
+            Archetype& archetype = *archetypes_[record.archetype];
+            (new (archetype.template Row<std::remove_cvref_t<Ts>>(record.row)) std::remove_cvref_t<Ts>(std::forward<Ts>(components)), ...);
+            return entity;
+        }
+
+        void Destroy(Entity entity);
+        bool IsAlive(Entity entity) const;
+        size_t Size() const { return size_; }
+
+        // Replaces the component if the entity already has one. Null, and nothing added, if
+        // the entity is dead; otherwise valid as long as Get() would be.
+        template<typename T>
+        T* Add(Entity entity, T component = {})
+        {
+            if (!IsAlive(entity))
+                return nullptr;
+            if (T* existing = Get<T>(entity))
+                return &(*existing = std::move(component));
+
+            ComponentId id = GetComponentId<T>();
+            const Record& record = records_[entity.index];
+            Move(entity, archetypes_[record.archetype]->mask | (ComponentMask(1) << id));
+            return new (archetypes_[record.archetype]->template Row<T>(record.row)) T(std::move(component));
+        }
+
+        template<typename T>
+        void Remove(Entity entity)
+        {
+            if (Has<T>(entity))
+                Move(entity, archetypes_[records_[entity.index].archetype]->mask & ~(ComponentMask(1) << GetComponentId<T>()));
+        }
+
+        // Null if the entity is dead or has no T. Valid until the entity's next add, remove
+        // or destroy, or the creation of another entity with the same components.
+        template<typename T>
+        T* Get(Entity entity)
+        {
+            if (!IsAlive(entity))
+                return nullptr;
+            const Record& record = records_[entity.index];
+            Archetype& archetype = *archetypes_[record.archetype];
+            return archetype.Has(GetComponentId<T>()) ? archetype.template Row<T>(record.row) : nullptr;
+        }
+
+        template<typename T>
+        bool Has(Entity entity) const
+        {
+            return IsAlive(entity) && archetypes_[records_[entity.index].archetype]->Has(GetComponentId<T>());
+        }
+
+        // fn(Ts&...) or fn(Entity, Ts&...) for every entity with all of Ts.
+        template<typename... Ts, typename F>
+        void ForEach(F&& fn)
+        {
+            for (uint32_t index : Query(GetComponentMask<Ts...>()))
+            {
+                Archetype& archetype = *archetypes_[index];
+                Run<Ts...>(fn, archetype, 0, archetype.entities.size());
+            }
+        }
+
+        // ForEach split across the job system in chunks of at least min_chunk entities. One
+        // ParallelFor covers every matching archetype, so small archetypes don't each pay
+        // for a round of job setup.
+        template<typename... Ts, typename F>
+        void ParallelForEach(F&& fn, size_t min_chunk = 1024)
+        {
+            const std::vector<uint32_t>& matches = Query(GetComponentMask<Ts...>());
+
+            auto& arena = GetFrameArena();
+            FrameArena::Scope scope(arena);
+            ArenaVector<size_t> starts(&arena);
+            starts.reserve(matches.size() + 1);
+            size_t total = 0;
+            for (uint32_t index : matches)
+            {
+                starts.push_back(total);
+                total += archetypes_[index]->entities.size();
+            }
+            starts.push_back(total);
+
+            jobs_->ParallelFor(total, [&](size_t begin, size_t end)
+            {
+                size_t a = (size_t)(std::upper_bound(starts.begin(), starts.end(), begin) - starts.begin()) - 1;
+                while (begin < end)
+                {
+                    size_t archetype_end = std::min(end, starts[a + 1]);
+                    Run<Ts...>(fn, *archetypes_[matches[a]], begin - starts[a], archetype_end - starts[a]);
+                    begin = archetype_end;
+                    a++;
+                }
+            }, min_chunk);
+        }
+
+    private:
+        static constexpr uint32_t NO_ARCHETYPE = 0xFFFFFFFF;
+
+        struct Column
+        {
+            ComponentId component;
+            std::byte* data;
+        };
+
+        struct Archetype
+        {
+            ComponentMask mask;
+            std::vector<Column> columns{};
+            std::array<int8_t, MAX_COMPONENTS> column_of{};     // -1 when absent
+            std::vector<Entity> entities{};
+            size_t capacity = 0;
+
+            bool Has(ComponentId id) const { return (mask >> id) & 1; }
+
+            template<typename T>
+            T* Row(size_t row) { return reinterpret_cast<T*>(columns[column_of[GetComponentId<T>()]].data) + row; }
+        };
+
+        struct Record
+        {
+            uint32_t archetype;
+            uint32_t row;
+            uint32_t generation;
+        };
+
+        struct QueryCache
+        {
+            std::vector<uint32_t> archetypes{};
+            size_t checked = 0;     // archetypes_ already tested against the mask
+        };
+
+        template<typename... Ts, typename F>
+        static void Run(F& fn, Archetype& archetype, size_t begin, size_t end)
+        {
+            std::tuple<Ts*...> columns{archetype.template Row<Ts>(0)...};
+            const Entity* entities = archetype.entities.data();
+            for (size_t row = begin; row < end; row++)
+            {
+                if constexpr (std::is_invocable_v<F&, Entity, Ts&...>)
+                    fn(entities[row], std::get<Ts*>(columns)[row]...);
+                else
+                    fn(std::get<Ts*>(columns)[row]...);
+            }
+        }
+
+        // A new entity with an uninitialized row in mask's archetype.
+        Entity CreateIn(ComponentMask mask);
+        // Moves the entity's row to mask's archetype, relocating the components both have and
+        // destroying the rest; new components are left uninitialized.
+        void Move(Entity entity, ComponentMask mask);
+        uint32_t GetArchetype(ComponentMask mask);
+        uint32_t AddRow(Archetype& archetype, Entity entity);
+        // Moves the last row into row; the components at row must already be moved or destroyed.
+        void RemoveRow(Archetype& archetype, uint32_t row);
+        const std::vector<uint32_t>& Query(ComponentMask mask);
+
+        JobSystem* jobs_;
+        std::vector<std::unique_ptr<Archetype>> archetypes_{};
+        std::unordered_map<ComponentMask, uint32_t> archetype_of_mask_{};
+        std::unordered_map<ComponentMask, QueryCache> queries_{};
+        std::vector<Record> records_{};
+        std::vector<uint32_t> free_records_{};
+        size_t size_ = 0;
+    };
+
+    // Records every entity with a Transform and a Sprite, from the job system's threads.
+    void DrawSprites(World& world, RenderQueue& queue);
+    // Immediate debug outlines of every entity with a Transform and a Hitbox.
+    void DrawHitboxes(World& world, Camera2d camera, glm::vec4 color);
+    // Tests entity's Transform and Hitbox against every other entity that has both, calling
+    // fn for each overlap with the penetration that pushes entity out of the other one.
+    void ForEachCollision(World& world, Entity entity, FunctionRef<void(Entity, const CollisionResult&)> fn);
+}
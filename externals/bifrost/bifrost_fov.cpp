@@ -0,0 +1,348 @@
+#include "bifrost_fov.h"
+
+#include <algorithm>
+
+namespace
+{
+
+bool shader_initialized = false;
+bifrost::Shader fog_shader;
+unsigned int fullscreen_vao;
+
+const char* fog_vs =
+R"(#version 450 core
+out vec2 world_position;
+uniform mat4 inverse_vp;
+void main()
+{
+    vec2 ndc = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    gl_Position = vec4(ndc, 0.0, 1.0);
+    world_position = (inverse_vp * vec4(ndc, 0.0, 1.0)).xy;
+}
+)";
+
+const char* fog_fs =
+R"(#version 450 core
+in vec2 world_position;
+uniform sampler2D mask;
+uniform vec2 origin;
+uniform vec2 map_world_size;
+uniform vec4 color;
+out vec4 fragment_color;
+void main()
+{
+    vec2 uv = (world_position - origin) / map_world_size;
+    if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0))))
+        discard;
+
+    float light = texture(mask, uv).r;
+    fragment_color = vec4(color.rgb, color.a * (1.0 - light));
+})";
+
+const uint8_t MASK_UNEXPLORED = 0;
+const uint8_t MASK_EXPLORED = 128;
+const uint8_t MASK_VISIBLE = 255;
+
+void InitializeFogShader()
+{
+    if (shader_initialized)
+        return;
+
+    shader_initialized = true;
+    fog_shader = bifrost::GenShaderFromSource(fog_vs, fog_fs);
+    glGenVertexArrays(1, &fullscreen_vao);
+}
+
+inline bool TestBit(const std::vector<uint64_t>& bits, size_t bit)
+{
+    return (bits[bit >> 6] >> (bit & 63)) & 1;
+}
+
+inline void SetBit(std::vector<uint64_t>& bits, size_t bit)
+{
+    bits[bit >> 6] |= 1ull << (bit & 63);
+}
+
+inline void ClearBit(std::vector<uint64_t>& bits, size_t bit)
+{
+    bits[bit >> 6] &= ~(1ull << (bit & 63));
+}
+
+// Same test as IsTileSolid, inlined since every scanned tile hits it.
+inline bool IsWall(const bifrost::TileCollisionGrid& grid, int x, int y)
+{
+    if ((unsigned)x >= (unsigned)grid.width || (unsigned)y >= (unsigned)grid.height)
+        return true;
+    return TestBit(grid.solid, (size_t)y * grid.width + x);
+}
+
+int FloorDiv(int a, int b)
+{
+    int q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// Slopes are kept as exact fractions so the scan is symmetric; den is always positive.
+struct Slope
+{
+    int num;
+    int den;
+};
+
+struct Row
+{
+    int depth;
+    Slope start;
+    Slope end;
+};
+
+// Converts (depth, col) in one of the four quadrants to grid coordinates.
+glm::ivec2 QuadrantToGrid(int quadrant, glm::ivec2 viewer, int depth, int col)
+{
+    switch (quadrant)
+    {
+    case 0:  return {viewer.x + col, viewer.y + depth};
+    case 1:  return {viewer.x + depth, viewer.y + col};
+    case 2:  return {viewer.x + col, viewer.y - depth};
+    default: return {viewer.x - depth, viewer.y + col};
+    }
+}
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+void ComputeFieldOfView(const TileCollisionGrid& grid, glm::ivec2 viewer, int radius, std::vector<uint64_t>& visible)
+{
+    if (viewer.x < 0 || viewer.y < 0 || viewer.x >= grid.width || viewer.y >= grid.height)
+        return;
+
+    SetBit(visible, (size_t)viewer.y * grid.width + viewer.x);
+
+    const int radius_squared = radius * radius + radius;
+    FrameArena::Scope scope(GetFrameArena());
+    ArenaVector<Row> rows(&GetFrameArena());
+
+    for (int quadrant = 0; quadrant < 4; quadrant++)
+    {
+        rows.push_back({1, {-1, 1}, {1, 1}});
+        while (!rows.empty())
+        {
+            Row row = rows.back();
+            rows.pop_back();
+
+            // Columns whose centre lies within [start, end], rounding ties outwards at the
+            // start and inwards at the end.
+            int min_col = FloorDiv(2 * row.depth * row.start.num + row.start.den, 2 * row.start.den);
+            int max_col = -FloorDiv(-(2 * row.depth * row.end.num - row.end.den), 2 * row.end.den);
+
+            int prev = -1; // -1 none, 0 floor, 1 wall
+            for (int col = min_col; col <= max_col; col++)
+            {
+                glm::ivec2 tile = QuadrantToGrid(quadrant, viewer, row.depth, col);
+                bool wall = IsWall(grid, tile.x, tile.y);
+
+                // Floors are only revealed when their centre is inside the row's slopes, which
+                // is what makes the result symmetric; walls are revealed whenever touched.
+                bool symmetric = col * row.start.den >= row.depth * row.start.num &&
+                                 col * row.end.den <= row.depth * row.end.num;
+                if ((wall || symmetric) && col * col + row.depth * row.depth <= radius_squared &&
+                    tile.x >= 0 && tile.y >= 0 && tile.x < grid.width && tile.y < grid.height)
+                {
+                    SetBit(visible, (size_t)tile.y * grid.width + tile.x);
+                }
+
+                Slope tile_slope = {2 * col - 1, 2 * row.depth};
+                if (prev == 1 && !wall)
+                    row.start = tile_slope;
+                if (prev == 0 && wall && row.depth < radius)
+                    rows.push_back({row.depth + 1, row.start, tile_slope});
+                prev = wall ? 1 : 0;
+            }
+
+            if (prev == 0 && row.depth < radius)
+                rows.push_back({row.depth + 1, row.start, row.end});
+        }
+    }
+}
+
+FogOfWar::FogOfWar(int width, int height, glm::vec2 tile_draw_size, glm::vec2 origin)
+    : width_(width)
+    , height_(height)
+    , tile_draw_size_(tile_draw_size)
+    , origin_(origin)
+{
+    size_t words = ((size_t)width * height + 63) / 64;
+    visible_.assign(words, 0);
+    explored_.assign(words, 0);
+    mask_.assign((size_t)width * height, MASK_UNEXPLORED);
+}
+
+FogOfWar::~FogOfWar()
+{
+    if (mask_texture_)
+        glDeleteTextures(1, &mask_texture_);
+}
+
+void FogOfWar::Update(const TileCollisionGrid& grid, glm::ivec2 viewer, int radius)
+{
+    if (grid.width != width_ || grid.height != height_)
+        return;
+    if (!stale_ && viewer == viewer_ && radius == radius_)
+        return;
+
+    // Only tiles within the previous radius can have been visible.
+    glm::ivec2 old_min{0}, old_max{-1};
+    if (radius_ >= 0)
+    {
+        old_min = glm::max(viewer_ - radius_, glm::ivec2(0));
+        old_max = glm::min(viewer_ + radius_, glm::ivec2(width_ - 1, height_ - 1));
+        for (int y = old_min.y; y <= old_max.y; y++)
+            for (int x = old_min.x; x <= old_max.x; x++)
+                ClearBit(visible_, (size_t)y * width_ + x);
+    }
+
+    ComputeFieldOfView(grid, viewer, radius, visible_);
+
+    glm::ivec2 new_min = glm::max(viewer - radius, glm::ivec2(0));
+    glm::ivec2 new_max = glm::min(viewer + radius, glm::ivec2(width_ - 1, height_ - 1));
+
+    glm::ivec2 region_min = new_min;
+    glm::ivec2 region_max = new_max;
+    if (old_max.x >= old_min.x)
+    {
+        region_min = glm::min(region_min, old_min);
+        region_max = glm::max(region_max, old_max);
+    }
+
+    for (int y = region_min.y; y <= region_max.y; y++)
+    {
+        for (int x = region_min.x; x <= region_max.x; x++)
+        {
+            size_t bit = (size_t)y * width_ + x;
+            uint8_t value = MASK_UNEXPLORED;
+            if (TestBit(visible_, bit))
+            {
+                SetBit(explored_, bit);
+                value = MASK_VISIBLE;
+            }
+            else if (TestBit(explored_, bit))
+            {
+                value = MASK_EXPLORED;
+            }
+            mask_[bit] = value;
+        }
+    }
+
+    if (region_max.x >= region_min.x && region_max.y >= region_min.y)
+    {
+        if (dirty_max_.x < dirty_min_.x)
+        {
+            dirty_min_ = region_min;
+            dirty_max_ = region_max;
+        }
+        else
+        {
+            dirty_min_ = glm::min(dirty_min_, region_min);
+            dirty_max_ = glm::max(dirty_max_, region_max);
+        }
+    }
+
+    viewer_ = viewer;
+    radius_ = radius;
+    stale_ = false;
+}
+
+void FogOfWar::Invalidate()
+{
+    stale_ = true;
+}
+
+void FogOfWar::Reset()
+{
+    std::fill(visible_.begin(), visible_.end(), 0);
+    std::fill(explored_.begin(), explored_.end(), 0);
+    std::fill(mask_.begin(), mask_.end(), MASK_UNEXPLORED);
+    dirty_min_ = glm::ivec2(0);
+    dirty_max_ = glm::ivec2(width_ - 1, height_ - 1);
+    radius_ = -1;
+    stale_ = true;
+}
+
+bool FogOfWar::IsVisible(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= width_ || y >= height_)
+        return false;
+    return TestBit(visible_, (size_t)y * width_ + x);
+}
+
+bool FogOfWar::IsExplored(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= width_ || y >= height_)
+        return false;
+    return TestBit(explored_, (size_t)y * width_ + x);
+}
+
+void FogOfWar::UploadMask()
+{
+    if (!mask_texture_)
+    {
+        glGenTextures(1, &mask_texture_);
+        glBindTexture(GL_TEXTURE_2D, mask_texture_);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, width_, height_);
+        dirty_min_ = glm::ivec2(0);
+        dirty_max_ = glm::ivec2(width_ - 1, height_ - 1);
+    }
+    else
+    {
+        glBindTexture(GL_TEXTURE_2D, mask_texture_);
+    }
+
+    if (dirty_max_.x < dirty_min_.x)
+        return;
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, width_);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, dirty_min_.x, dirty_min_.y,
+        dirty_max_.x - dirty_min_.x + 1, dirty_max_.y - dirty_min_.y + 1,
+        GL_RED, GL_UNSIGNED_BYTE, &mask_[(size_t)dirty_min_.y * width_ + dirty_min_.x]);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    dirty_min_ = glm::ivec2(0);
+    dirty_max_ = glm::ivec2(-1);
+}
+
+Texture FogOfWar::GetMaskTexture()
+{
+    UploadMask();
+    return Texture{mask_texture_, (unsigned int)width_, (unsigned int)height_};
+}
+
+void FogOfWar::Draw(Camera2d camera, glm::vec4 color)
+{
+    InitializeFogShader();
+
+    glActiveTexture(GL_TEXTURE0);
+    UploadMask();
+
+    unsigned int id = fog_shader.id;
+    glUseProgram(id);
+    glUniformMatrix4fv(glGetUniformLocation(id, "inverse_vp"), 1, GL_FALSE, glm::value_ptr(glm::inverse(camera.projection)));
+    glUniform1i(glGetUniformLocation(id, "mask"), 0);
+    glUniform2fv(glGetUniformLocation(id, "origin"), 1, glm::value_ptr(origin_));
+    glUniform2fv(glGetUniformLocation(id, "map_world_size"), 1, glm::value_ptr(tile_draw_size_ * glm::vec2((float)width_, (float)height_)));
+    glUniform4fv(glGetUniformLocation(id, "color"), 1, glm::value_ptr(color));
+
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(fullscreen_vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+}
+
+} // namespace bifrost
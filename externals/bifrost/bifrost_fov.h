@@ -0,0 +1,67 @@
+#pragma once
+
+#include "bifrost.h"
+#include "bifrost_collision.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace bifrost
+{
+    // Symmetric shadowcasting over the solid tiles of a grid: if A can see B then B can see A,
+    // and walls bounding a visible area are visible themselves. Sets the bit of every tile
+    // within radius of viewer that it can see; bits are never cleared, so visible must hold
+    // width * height bits and be cleared by the caller as needed.
+    void ComputeFieldOfView(const TileCollisionGrid& grid, glm::ivec2 viewer, int radius, std::vector<uint64_t>& visible);
+
+    // Per-tile visibility and exploration for one viewer. Update() only touches the squares
+    // around the previous and current viewer positions and does nothing if the viewer and
+    // radius are unchanged, so its cost depends on the radius rather than the map size. It
+    // can't see edits to the grid; call Invalidate() after changing it.
+    // The fog is kept as an R8 mask texture (0 unexplored, 128 explored, 255 visible) in which
+    // only the changed square is uploaded on the next Draw() or GetMaskTexture().
+    class FogOfWar
+    {
+    public:
+        FogOfWar(int width, int height, glm::vec2 tile_draw_size, glm::vec2 origin = glm::vec2(0.0f));
+        ~FogOfWar();
+
+        FogOfWar(const FogOfWar&) = delete;
+        FogOfWar& operator=(const FogOfWar&) = delete;
+
+        void Update(const TileCollisionGrid& grid, glm::ivec2 viewer, int radius);
+        // Forces the next Update() to recompute; needed after any grid change, e.g. a door opening.
+        void Invalidate();
+        // Forgets everything explored so far.
+        void Reset();
+
+        bool IsVisible(int x, int y) const;
+        bool IsExplored(int x, int y) const;
+
+        // Darkens unexplored tiles fully and explored but not visible ones by half, scaled by color.a.
+        void Draw(Camera2d camera, glm::vec4 color = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+        Texture GetMaskTexture();
+
+        int Width() const { return width_; }
+        int Height() const { return height_; }
+        const std::vector<uint64_t>& GetVisible() const { return visible_; }
+        const std::vector<uint64_t>& GetExplored() const { return explored_; }
+
+    private:
+        void UploadMask();
+
+        int width_;
+        int height_;
+        glm::vec2 tile_draw_size_;
+        glm::vec2 origin_;
+        std::vector<uint64_t> visible_{};
+        std::vector<uint64_t> explored_{};
+        std::vector<uint8_t> mask_{};
+        glm::ivec2 viewer_{0};
+        int radius_ = -1;
+        bool stale_ = true;
+        unsigned int mask_texture_ = 0;
+        glm::ivec2 dirty_min_{0};
+        glm::ivec2 dirty_max_{-1};
+    };
+}
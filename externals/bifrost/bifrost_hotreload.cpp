@@ -0,0 +1,397 @@
+#include "bifrost_hotreload.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace
+{
+
+const unsigned int stage_types[3] = {GL_VERTEX_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER};
+const char* stage_names[3] = {"vertex", "geometry", "fragment"};
+
+std::filesystem::path NormalizePath(const char* file)
+{
+    std::error_code ec;
+    auto path = std::filesystem::absolute(file, ec);
+    if (ec)
+        return std::filesystem::path(file).lexically_normal();
+    return path.lexically_normal();
+}
+
+std::filesystem::file_time_type GetWriteTime(const std::filesystem::path& file)
+{
+    std::error_code ec;
+    auto time = std::filesystem::last_write_time(file, ec);
+    return ec ? std::filesystem::file_time_type{} : time;
+}
+
+bool ReadFile(const std::filesystem::path& file, std::string& out)
+{
+    std::ifstream stream(file, std::ios::binary);
+    if (!stream)
+        return false;
+    std::stringstream buffer;
+    buffer << stream.rdbuf();
+    out = buffer.str();
+    return !out.empty();
+}
+
+bool HasExtension(const char* name)
+{
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int i = 0; i < count; i++)
+    {
+        const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (ext && strcmp(ext, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+// Compiles every non-empty stage and links them. With parallel compile support the driver
+// does the work off-thread and the status is only checked once it reports completion.
+unsigned int StartBuild(const std::string (&sources)[3], unsigned int (&stages)[3])
+{
+    unsigned int program = glCreateProgram();
+
+    for (int i = 0; i < 3; i++)
+    {
+        stages[i] = 0;
+        if (sources[i].empty())
+            continue;
+
+        const char* code = sources[i].c_str();
+        stages[i] = glCreateShader(stage_types[i]);
+        glShaderSource(stages[i], 1, &code, NULL);
+        glCompileShader(stages[i]);
+        glAttachShader(program, stages[i]);
+    }
+
+    glLinkProgram(program);
+    return program;
+}
+
+// Returns true if the program linked; logs any compile or link errors and releases the stages.
+bool FinishBuild(unsigned int program, const unsigned int (&stages)[3])
+{
+    char log[1024];
+    for (int i = 0; i < 3; i++)
+    {
+        if (!stages[i])
+            continue;
+
+        int compiled = 0;
+        glGetShaderiv(stages[i], GL_COMPILE_STATUS, &compiled);
+        if (!compiled)
+        {
+            glGetShaderInfoLog(stages[i], sizeof(log), NULL, log);
+            fprintf(stderr, "bifrost: %s shader failed to compile:\n%s\n", stage_names[i], log);
+        }
+        glDetachShader(program, stages[i]);
+        glDeleteShader(stages[i]);
+    }
+
+    int linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        fprintf(stderr, "bifrost: shader reload failed, keeping previous program:\n%s\n", log);
+    }
+    return linked;
+}
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+ShaderWatcher::ShaderWatcher()
+{
+#ifdef __linux__
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    running_ = true;
+    thread_ = std::thread(&ShaderWatcher::WatchThread, this);
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+    running_ = false;
+    if (thread_.joinable())
+        thread_.join();
+
+#ifdef __linux__
+    if (inotify_fd_ >= 0)
+        close(inotify_fd_);
+#endif
+
+    for (auto& build : in_flight_)
+    {
+        FinishBuild(build.program, build.stages);
+        glDeleteProgram(build.program);
+    }
+}
+
+void ShaderWatcher::Watch(Shader* shader, const char* vert_shader_file, const char* frag_shader_file)
+{
+    AddWatch(shader, vert_shader_file, "", frag_shader_file);
+}
+
+void ShaderWatcher::Watch(Shader* shader, const char* vert_shader_file, const char* geom_shader_file, const char* frag_shader_file)
+{
+    AddWatch(shader, vert_shader_file, geom_shader_file, frag_shader_file);
+}
+
+void ShaderWatcher::AddWatch(Shader* shader, const char* vert_shader_file, const char* geom_shader_file, const char* frag_shader_file)
+{
+    const char* files[3] = {vert_shader_file, geom_shader_file, frag_shader_file};
+
+    WatchedShader watched = {};
+    watched.shader = shader;
+    for (int i = 0; i < 3; i++)
+    {
+        if (!strlen(files[i]))
+            continue;
+        watched.files[i] = NormalizePath(files[i]);
+        watched.write_times[i] = GetWriteTime(watched.files[i]);
+    }
+
+    std::lock_guard lock(mutex_);
+    watched.watch_id = next_watch_id_++;
+    watched_.push_back(watched);
+
+#ifdef __linux__
+    if (inotify_fd_ < 0)
+        return;
+
+    for (const auto& file : watched.files)
+    {
+        if (file.empty())
+            continue;
+
+        auto dir = file.parent_path();
+        bool known = std::any_of(directories_.begin(), directories_.end(), [&dir](const auto& d) { return d.second == dir; });
+        if (known)
+            continue;
+
+        // Watch the directory rather than the file: editors often save by writing a
+        // temporary and renaming it over the original, which drops a per-file watch.
+        int wd = inotify_add_watch(inotify_fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (wd >= 0)
+            directories_.push_back({wd, dir});
+    }
+#endif
+}
+
+void ShaderWatcher::Unwatch(Shader* shader)
+{
+    std::lock_guard lock(mutex_);
+    std::erase_if(watched_, [shader](const WatchedShader& w) { return w.shader == shader; });
+    std::erase_if(pending_, [shader](const PendingBuild& p) { return p.shader == shader; });
+    std::erase_if(in_flight_, [shader](const InFlightBuild& b)
+    {
+        if (b.shader != shader)
+            return false;
+        FinishBuild(b.program, b.stages);
+        glDeleteProgram(b.program);
+        return true;
+    });
+}
+
+int ShaderWatcher::Update()
+{
+    if (parallel_compile_ < 0)
+        parallel_compile_ = HasExtension("GL_KHR_parallel_shader_compile") || HasExtension("GL_ARB_parallel_shader_compile");
+
+    std::vector<PendingBuild> pending;
+    {
+        std::lock_guard lock(mutex_);
+        std::swap(pending, pending_);
+    }
+
+    for (auto& build : pending)
+    {
+        InFlightBuild started = {};
+        started.shader = build.shader;
+        started.program = StartBuild(build.sources, started.stages);
+        in_flight_.push_back(started);
+    }
+
+    int swapped = 0;
+    std::erase_if(in_flight_, [this, &swapped](const InFlightBuild& build)
+    {
+        if (parallel_compile_)
+        {
+            int complete = 0;
+            glGetProgramiv(build.program, GL_COMPLETION_STATUS_KHR, &complete);
+            if (!complete)
+                return false;
+        }
+
+        if (!FinishBuild(build.program, build.stages))
+        {
+            glDeleteProgram(build.program);
+            return true;
+        }
+
+        if (build.shader->id)
+            glDeleteProgram(build.shader->id);
+        build.shader->id = build.program;
+        swapped++;
+        return true;
+    });
+
+    return swapped;
+}
+
+void ShaderWatcher::MarkDirty(const std::filesystem::path& file)
+{
+    std::lock_guard lock(mutex_);
+    for (auto& watched : watched_)
+        for (const auto& f : watched.files)
+            if (!f.empty() && f == file)
+                watched.dirty = true;
+}
+
+void ShaderWatcher::ReadDirtySources()
+{
+    std::vector<WatchedShader> dirty{};
+    {
+        std::lock_guard lock(mutex_);
+        for (auto& watched : watched_)
+        {
+            if (!watched.dirty)
+                continue;
+            watched.dirty = false;
+            dirty.push_back(watched);
+        }
+    }
+
+    if (dirty.empty())
+        return;
+
+    // Read outside the lock; the main thread only ever blocks on the queue swap.
+    std::vector<PendingBuild> builds{};
+    for (const auto& watched : dirty)
+    {
+        PendingBuild build = {};
+        build.shader = watched.shader;
+        build.watch_id = watched.watch_id;
+        bool ok = true;
+        for (int stage = 0; stage < 3; stage++)
+        {
+            const auto& path = watched.files[stage];
+            if (!path.empty() && !ReadFile(path, build.sources[stage]))
+                ok = false;
+        }
+        if (ok)
+            builds.push_back(std::move(build));
+    }
+
+    std::lock_guard lock(mutex_);
+    for (auto& build : builds)
+    {
+        // Unwatch() may have run while the files were read, and the Shader may be gone.
+        bool still_watched = std::any_of(watched_.begin(), watched_.end(), [&build](const WatchedShader& w)
+        {
+            return w.shader == build.shader && w.watch_id == build.watch_id;
+        });
+        if (!still_watched)
+            continue;
+
+        // A newer edit supersedes a build that hasn't been picked up yet.
+        std::erase_if(pending_, [&build](const PendingBuild& p) { return p.shader == build.shader; });
+        pending_.push_back(std::move(build));
+    }
+}
+
+void ShaderWatcher::WatchThread()
+{
+    using namespace std::chrono_literals;
+
+    while (running_)
+    {
+        bool changed = false;
+
+#ifdef __linux__
+        if (inotify_fd_ >= 0)
+        {
+            pollfd pfd = {inotify_fd_, POLLIN, 0};
+            if (poll(&pfd, 1, 100) <= 0)
+                continue;
+
+            alignas(inotify_event) char buffer[4096];
+            ssize_t length;
+            while ((length = read(inotify_fd_, buffer, sizeof(buffer))) > 0)
+            {
+                for (char* p = buffer; p < buffer + length; )
+                {
+                    auto* event = reinterpret_cast<inotify_event*>(p);
+                    p += sizeof(inotify_event) + event->len;
+                    if (!event->len)
+                        continue;
+
+                    std::filesystem::path dir{};
+                    {
+                        std::lock_guard lock(mutex_);
+                        for (const auto& [wd, d] : directories_)
+                            if (wd == event->wd)
+                                dir = d;
+                    }
+                    if (dir.empty())
+                        continue;
+
+                    MarkDirty(dir / event->name);
+                    changed = true;
+                }
+            }
+        }
+        else
+#endif
+        {
+            std::this_thread::sleep_for(250ms);
+
+            std::lock_guard lock(mutex_);
+            for (auto& watched : watched_)
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    if (watched.files[i].empty())
+                        continue;
+                    auto time = GetWriteTime(watched.files[i]);
+                    if (time != watched.write_times[i])
+                    {
+                        watched.write_times[i] = time;
+                        watched.dirty = true;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        if (!changed)
+            continue;
+
+        // Editors tend to emit a burst of events per save; let the write settle before reading.
+        std::this_thread::sleep_for(50ms);
+        ReadDirtySources();
+    }
+}
+
+} // namespace bifrost
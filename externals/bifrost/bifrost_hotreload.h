@@ -0,0 +1,76 @@
+#pragma once
+
+#include "bifrost.h"
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bifrost
+{
+    // Watches shader source files and rebuilds the program when one of them changes.
+    // File watching (inotify on Linux, timestamp polling elsewhere) and source reads happen
+    // on a background thread; Update() must be called on the GL thread between frames and
+    // swaps rebuilt programs into the watched Shader. A program that fails to compile or link
+    // is discarded and the previous one stays in place.
+    class ShaderWatcher
+    {
+    public:
+        ShaderWatcher();
+        ~ShaderWatcher();
+
+        ShaderWatcher(const ShaderWatcher&) = delete;
+        ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+        void Watch(Shader* shader, const char* vert_shader_file, const char* frag_shader_file);
+        void Watch(Shader* shader, const char* vert_shader_file, const char* geom_shader_file, const char* frag_shader_file);
+        // Must be called on the GL thread, like Update().
+        void Unwatch(Shader* shader);
+
+        // Returns the number of programs swapped in this call.
+        int Update();
+
+    private:
+        struct WatchedShader
+        {
+            Shader* shader;
+            uint64_t watch_id;      // tells a rewatch of a reused Shader address apart
+            std::filesystem::path files[3];
+            std::filesystem::file_time_type write_times[3];
+            bool dirty;
+        };
+
+        struct PendingBuild
+        {
+            Shader* shader;
+            uint64_t watch_id;
+            std::string sources[3];
+        };
+
+        struct InFlightBuild
+        {
+            Shader* shader;
+            unsigned int program;
+            unsigned int stages[3];
+        };
+
+        void AddWatch(Shader* shader, const char* vert_shader_file, const char* geom_shader_file, const char* frag_shader_file);
+        void WatchThread();
+        void MarkDirty(const std::filesystem::path& file);
+        void ReadDirtySources();
+
+        std::mutex mutex_{};
+        std::vector<WatchedShader> watched_{};
+        uint64_t next_watch_id_ = 1;
+        std::vector<PendingBuild> pending_{};
+        std::vector<InFlightBuild> in_flight_{};
+        std::vector<std::pair<int, std::filesystem::path>> directories_{};
+        std::atomic<bool> running_{false};
+        std::thread thread_{};
+        int inotify_fd_ = -1;
+        int parallel_compile_ = -1;
+    };
+}
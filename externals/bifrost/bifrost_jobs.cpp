@@ -0,0 +1,222 @@
+#include "bifrost_jobs.h"
+
+#include <algorithm>
+
+namespace
+{
+
+// Which system and deque the current thread belongs to; workers set these on start.
+thread_local const bifrost::JobSystem* current_system = nullptr;
+thread_local int current_queue = -1;
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+JobSystem::JobSystem(int worker_count)
+{
+    if (worker_count < 0)
+        worker_count = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+
+    // One deque per worker plus the shared one for every other thread.
+    for (int i = 0; i <= worker_count; i++)
+        queues_.push_back(std::make_unique<Queue>());
+
+    for (int i = 0; i < worker_count; i++)
+        workers_.emplace_back(&JobSystem::WorkerThread, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard lock(sleep_mutex_);
+        running_ = false;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+int JobSystem::QueueIndex() const
+{
+    return current_system == this ? current_queue : (int)workers_.size();
+}
+
+void JobSystem::Run(JobFunction job, JobCounter* counter)
+{
+    if (counter)
+        counter->value_.fetch_add(1, std::memory_order_relaxed);
+    Push(Job{std::move(job), counter});
+}
+
+void JobSystem::Run(JobFunction job, JobCounter& dependency, JobCounter* counter)
+{
+    if (counter)
+        counter->value_.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        std::lock_guard lock(dependency.mutex_);
+        if (dependency.value_.load(std::memory_order_acquire) != 0)
+        {
+            dependency.continuations_.push_back(Job{std::move(job), counter});
+            return;
+        }
+    }
+    Push(Job{std::move(job), counter});
+}
+
+void JobSystem::Push(Job job)
+{
+    auto& queue = *queues_[QueueIndex()];
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+
+    pending_.fetch_add(1, std::memory_order_release);
+    // A worker between checking pending_ and sleeping holds sleep_mutex_; taking it here
+    // means the notify can't slip in between and be lost.
+    {
+        std::lock_guard lock(sleep_mutex_);
+    }
+    wake_.notify_one();
+}
+
+bool JobSystem::TryRunOne()
+{
+    if (pending_.load(std::memory_order_acquire) <= 0)
+        return false;
+
+    Job job{};
+    bool found = false;
+
+    // Own deque first, newest job, while its data is still in cache.
+    int own = QueueIndex();
+    {
+        auto& queue = *queues_[own];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            found = true;
+        }
+    }
+
+    // Then steal the oldest job from the others, starting somewhere different each time
+    // so thieves spread out.
+    int count = (int)queues_.size();
+    int start = (int)(steal_start_.fetch_add(1, std::memory_order_relaxed) % count);
+    for (int i = 0; i < count && !found; i++)
+    {
+        int index = (start + i) % count;
+        if (index == own)
+            continue;
+
+        auto& queue = *queues_[index];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found)
+        return false;
+
+    pending_.fetch_sub(1, std::memory_order_relaxed);
+    job.function();
+    if (job.counter)
+        Finish(job.counter);
+    return true;
+}
+
+void JobSystem::Finish(JobCounter* counter)
+{
+    // The decrement happens under the counter's lock, and Wait() takes the same lock before
+    // returning, so the counter stays alive until this is done with it.
+    std::vector<Job> ready{};
+    {
+        std::lock_guard lock(counter->mutex_);
+        if (counter->value_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            ready.swap(counter->continuations_);
+    }
+
+    for (auto& job : ready)
+        Push(std::move(job));
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    while (!counter.IsDone())
+    {
+        if (!TryRunOne())
+            std::this_thread::yield();
+    }
+
+    std::lock_guard lock(counter.mutex_);
+}
+
+bool JobSystem::YieldJob()
+{
+    return TryRunOne();
+}
+
+void JobSystem::ParallelFor(size_t count, FunctionRef<void(size_t, size_t)> fn, size_t min_chunk)
+{
+    if (count == 0)
+        return;
+
+    size_t chunks_wanted = (workers_.size() + 1) * 4;
+    size_t chunk = std::max(std::max<size_t>(min_chunk, 1), (count + chunks_wanted - 1) / chunks_wanted);
+    if (chunk >= count || workers_.empty())
+    {
+        fn(0, count);
+        return;
+    }
+
+    // Chunk jobs capture two words so they fit in std::function's inline storage and
+    // queueing them doesn't allocate.
+    struct Range
+    {
+        FunctionRef<void(size_t, size_t)> fn;
+        size_t count;
+        size_t chunk;
+    };
+    Range range{fn, count, chunk};
+
+    JobCounter counter{};
+    for (size_t begin = chunk; begin < count; begin += chunk)
+        Run([&range, begin]() { range.fn(begin, std::min(range.count, begin + range.chunk)); }, &counter);
+
+    fn(0, chunk);
+    Wait(counter);
+}
+
+void JobSystem::WorkerThread(int index)
+{
+    current_system = this;
+    current_queue = index;
+
+    while (true)
+    {
+        if (TryRunOne())
+            continue;
+
+        std::unique_lock lock(sleep_mutex_);
+        wake_.wait(lock, [this]() { return !running_ || pending_.load(std::memory_order_acquire) > 0; });
+        if (!running_)
+            return;
+    }
+}
+
+JobSystem& GetJobSystem()
+{
+    static JobSystem system{};
+    return system;
+}
+
+} // namespace bifrost
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "bifrost_arena.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bifrost
+{
+    using JobFunction = std::function<void()>;
+
+    class JobCounter;
+
+    struct Job
+    {
+        JobFunction function;
+        JobCounter* counter;
+    };
+
+    // Number of unfinished jobs started with this counter. Jobs queued with the counter as
+    // their dependency start once it drops to zero. Only destroy a counter after Wait() on
+    // it has returned.
+    class JobCounter
+    {
+    public:
+        JobCounter() = default;
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        bool IsDone() const { return value_.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<int> value_{0};
+        std::mutex mutex_{};
+        std::vector<Job> continuations_{};
+    };
+
+    // Worker threads with one deque each. A thread runs the newest job from its own deque
+    // and steals the oldest from the others when it runs dry; jobs queued from threads that
+    // are not workers go into a shared deque that is stolen from the same way. Threads
+    // blocked in Wait() run jobs while they wait, so jobs may wait on jobs they start.
+    class JobSystem
+    {
+    public:
+        // A negative worker_count uses one worker per hardware thread besides the caller's,
+        // and at least one. With zero workers, jobs only run inside Wait().
+        explicit JobSystem(int worker_count = -1);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        void Run(JobFunction job, JobCounter* counter = nullptr);
+        // Queues job once dependency reaches zero.
+        void Run(JobFunction job, JobCounter& dependency, JobCounter* counter);
+        void Wait(JobCounter& counter);
+
+        // Calls fn(begin, end) over [0, count) in chunks of at least min_chunk, a few per
+        // thread so uneven chunks still balance, and returns once all of them are done.
+        void ParallelFor(size_t count, FunctionRef<void(size_t, size_t)> fn, size_t min_chunk = 1);
+
+        // For long jobs: runs one pending job on this thread, so work queued behind the
+        // caller isn't held up. Returns false if there was nothing to run.
+        bool YieldJob();
+
+        int WorkerCount() const { return (int)workers_.size(); }
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        void Push(Job job);
+        bool TryRunOne();
+        void Finish(JobCounter* counter);
+        int QueueIndex() const;
+        void WorkerThread(int index);
+
+        std::vector<std::unique_ptr<Queue>> queues_{};
+        std::vector<std::thread> workers_{};
+        std::atomic<int> pending_{0};
+        std::atomic<unsigned int> steal_start_{0};
+        std::mutex sleep_mutex_{};
+        std::condition_variable wake_{};
+        bool running_ = true;
+    };
+
+    // Shared job system for bifrost modules and games, created on first use.
+    JobSystem& GetJobSystem();
+}
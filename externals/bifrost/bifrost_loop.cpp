@@ -0,0 +1,184 @@
+#include "bifrost_loop.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+
+// Frame times within this many seconds of a multiple of the refresh interval count as vsync.
+constexpr double VSYNC_SNAP_TOLERANCE = 0.0002;
+// Below this much time left, Capped pacing spins instead of sleeping.
+constexpr double SPIN_THRESHOLD = 0.002;
+
+double SteadySeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+GameLoop::GameLoop(UpdateFunction update, RenderFunction render, double update_rate, int max_steps)
+    : update_(std::move(update)), render_(std::move(render)), step_(1.0 / std::max(update_rate, 1.0)),
+      max_steps_(std::max(max_steps, 1))
+{
+}
+
+void GameLoop::SetPacing(FramePacing pacing, double rate)
+{
+    pacing_ = pacing;
+    pacing_rate_ = std::max(rate, 0.0);
+    snap_error_ = 0.0;
+}
+
+void GameLoop::SetUpdateRate(double update_rate)
+{
+    // Keep the same fraction of a step so interpolation doesn't jump.
+    double alpha = accumulator_ / step_;
+    step_ = 1.0 / std::max(update_rate, 1.0);
+    accumulator_ = alpha * step_;
+}
+
+void GameLoop::SetMaxSteps(int max_steps)
+{
+    max_steps_ = std::max(max_steps, 1);
+}
+
+void GameLoop::Run(const std::function<bool()>& running)
+{
+    ResetClock();
+    while (running())
+        Frame();
+}
+
+int GameLoop::Frame()
+{
+    auto wall_start = SteadySeconds();
+    double frame_start = Now();
+    double elapsed = last_time_ < 0.0 ? 0.0 : frame_start - last_time_;
+    last_time_ = frame_start;
+
+    if (pacing_ == FramePacing::VSync)
+        elapsed = SnapToRefresh(elapsed);
+
+    int steps = Advance(elapsed);
+    Pace(wall_start);
+    stats_.frame_ms = (SteadySeconds() - wall_start) * 1000.0;
+    return steps;
+}
+
+int GameLoop::Advance(double elapsed)
+{
+    if (begin_frame_)
+        begin_frame_();
+
+    auto start = SteadySeconds();
+    int steps = RunUpdates(std::max(elapsed, 0.0));
+    auto rendered = SteadySeconds();
+    stats_.update_ms = (rendered - start) * 1000.0;
+
+    if (render_)
+        render_(Alpha());
+    if (present_)
+        present_();
+    stats_.render_ms = (SteadySeconds() - rendered) * 1000.0;
+
+    stats_.frames++;
+    stats_.last_steps = steps;
+    return steps;
+}
+
+void GameLoop::FastForward(uint64_t steps)
+{
+    float dt = (float)step_;
+    for (uint64_t i = 0; i < steps; i++)
+        update_(dt);
+    stats_.updates += steps;
+}
+
+void GameLoop::ResetClock()
+{
+    last_time_ = -1.0;
+    snap_error_ = 0.0;
+}
+
+void GameLoop::Reset()
+{
+    ResetClock();
+    accumulator_ = 0.0;
+    stats_ = {};
+}
+
+double GameLoop::Now() const
+{
+    return clock_ ? clock_() : SteadySeconds();
+}
+
+double GameLoop::SnapToRefresh(double elapsed)
+{
+    if (pacing_rate_ <= 0.0)
+        return elapsed;
+
+    // Carry whatever snapping removed into the next frame so the clock doesn't drift.
+    double interval = 1.0 / pacing_rate_;
+    double corrected = elapsed + snap_error_;
+    double multiple = std::round(corrected / interval);
+    if (multiple >= 1.0 && std::abs(corrected - multiple * interval) < VSYNC_SNAP_TOLERANCE)
+    {
+        snap_error_ = corrected - multiple * interval;
+        return multiple * interval;
+    }
+
+    snap_error_ = 0.0;
+    return corrected;
+}
+
+int GameLoop::RunUpdates(double elapsed)
+{
+    accumulator_ += elapsed;
+
+    int steps = 0;
+    float dt = (float)step_;
+    while (accumulator_ >= step_ && steps < max_steps_)
+    {
+        update_(dt);
+        accumulator_ -= step_;
+        steps++;
+    }
+    stats_.updates += steps;
+
+    // Past the cap the simulation falls behind real time rather than spending ever longer
+    // frames catching up; keep only the fraction of a step needed for interpolation.
+    if (accumulator_ >= step_)
+    {
+        double kept = std::fmod(accumulator_, step_);
+        stats_.dropped_time += accumulator_ - kept;
+        accumulator_ = kept;
+    }
+
+    return steps;
+}
+
+void GameLoop::Pace(double wall_start)
+{
+    if (pacing_ != FramePacing::Capped || pacing_rate_ <= 0.0)
+        return;
+
+    // Waits on wall time, not the SetClock() clock, which may only move when told to.
+    // Sleep most of the way, then spin, since sleeps overshoot by up to a scheduler tick.
+    double deadline = wall_start + 1.0 / pacing_rate_;
+    for (double left = deadline - SteadySeconds(); left > 0.0; left = deadline - SteadySeconds())
+    {
+        if (left > SPIN_THRESHOLD)
+            std::this_thread::sleep_for(std::chrono::duration<double>(left - SPIN_THRESHOLD));
+        else
+            std::this_thread::yield();
+    }
+}
+
+} // namespace bifrost
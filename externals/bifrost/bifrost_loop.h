@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace bifrost
+{
+    // How GameLoop::Run() spends the time between frames.
+    enum class FramePacing
+    {
+        Uncapped,   // render as often as possible
+        VSync,      // the present hook blocks on the swap; frame times close to a multiple of
+                    // the refresh interval are snapped to it so vsync jitter doesn't leak into
+                    // the number of updates per frame
+        Capped,     // sleep until the target frame time has passed
+    };
+
+    struct GameLoopStats
+    {
+        uint64_t updates;       // fixed updates run since construction or Reset()
+        uint64_t frames;        // rendered frames
+        int last_steps;         // updates run by the last frame
+        double dropped_time;    // seconds discarded by the max steps cap
+        double frame_ms;        // wall time of the last frame, including pacing
+        double update_ms;       // time the last frame spent in updates
+        double render_ms;       // time the last frame spent in render and present
+    };
+
+    // Fixed timestep runner. Real time is added to an accumulator and drained in fixed
+    // update steps, so simulation results don't depend on frame rate; the render callback
+    // gets the leftover fraction of a step to interpolate between the last two states.
+    // A frame runs at most max_steps updates and drops any time beyond that, so a slow
+    // frame can't cause a spiral of ever longer catch-up frames.
+    class GameLoop
+    {
+    public:
+        using UpdateFunction = std::function<void(float dt)>;
+        using RenderFunction = std::function<void(float alpha)>;
+        using HookFunction   = std::function<void()>;
+
+        GameLoop(UpdateFunction update, RenderFunction render, double update_rate = 60.0, int max_steps = 5);
+
+        // Called once per frame before the updates, e.g. to poll input.
+        void SetBeginFrame(HookFunction fn) { begin_frame_ = std::move(fn); }
+        // Called after render, e.g. to swap buffers. Frame pacing starts once it returns.
+        void SetPresent(HookFunction fn) { present_ = std::move(fn); }
+        // Seconds since some fixed point; defaults to a steady clock. Only the simulation
+        // follows it: Capped pacing always waits on the steady clock.
+        void SetClock(std::function<double()> clock) { clock_ = std::move(clock); }
+
+        // rate is the target frames per second for Capped and the display refresh rate for
+        // VSync, where zero turns snapping off.
+        void SetPacing(FramePacing pacing, double rate = 0.0);
+        void SetUpdateRate(double update_rate);
+        void SetMaxSteps(int max_steps);
+
+        // Runs frames until running returns false.
+        void Run(const std::function<bool()>& running);
+        // One frame: begin hook, updates for the time since the last frame, render, present
+        // and pacing. Returns the number of updates run.
+        int Frame();
+        // One frame for an explicit amount of elapsed time, without the clock or pacing; for
+        // driving the loop from somewhere else.
+        int Advance(double elapsed);
+
+        // Headless: runs steps updates back to back, without hooks, rendering or pacing. For
+        // replays and benchmarks. Leaves the accumulator alone.
+        void FastForward(uint64_t steps);
+
+        // Forgets time that passed since the last frame, e.g. after a loading screen, so the
+        // next frame doesn't try to catch up.
+        void ResetClock();
+        void Reset();
+
+        float Alpha() const { return (float)(accumulator_ / step_); }
+        float FixedDelta() const { return (float)step_; }
+        double SimulationTime() const { return (double)stats_.updates * step_; }
+        const GameLoopStats& GetStats() const { return stats_; }
+
+    private:
+        double Now() const;
+        double SnapToRefresh(double elapsed);
+        int RunUpdates(double elapsed);
+        void Pace(double wall_start);
+
+        UpdateFunction update_;
+        RenderFunction render_;
+        HookFunction begin_frame_{};
+        HookFunction present_{};
+        std::function<double()> clock_{};
+
+        double step_;
+        int max_steps_;
+        FramePacing pacing_ = FramePacing::Uncapped;
+        double pacing_rate_ = 0.0;
+
+        double accumulator_ = 0.0;
+        double last_time_ = -1.0;
+        double snap_error_ = 0.0;
+        GameLoopStats stats_{};
+    };
+}
@@ -0,0 +1,643 @@
+#include "bifrost_particles.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <span>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BIFROST_PARTICLES_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+
+// PCG hash. The compute shader has the same function, so a particle's random numbers
+// depend only on the emitter seed and its spawn index, never on the backend.
+uint32_t Hash(uint32_t x)
+{
+    uint32_t state = x * 747796405u + 2891336453u;
+    uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+// Component k of the n'th particle an emitter spawns: 0 angle, 1 speed, 2 life, 3 and 4
+// the spawn box.
+float RandomRange(uint32_t seed, uint32_t n, uint32_t k, float min, float max)
+{
+    return min + (max - min) * (float)(Hash(seed + n * 6u + k) >> 8) * (1.0f / 16777216.0f);
+}
+
+// Color at life fraction t, as RGBA8 with red in the low byte.
+uint32_t PackColor(glm::vec4 start, glm::vec4 end, float t)
+{
+    glm::vec4 color = glm::clamp(start + (end - start) * t, 0.0f, 1.0f) * 255.0f + 0.5f;
+    return (uint32_t)color.r | (uint32_t)color.g << 8 | (uint32_t)color.b << 16 | (uint32_t)color.a << 24;
+}
+
+// The layout of a particle in a Gpu emitter's storage buffer, std430 on the shader side.
+struct GpuParticle
+{
+    glm::vec2 position;
+    glm::vec2 velocity;
+    float life;
+    float inverse_life;
+    uint32_t color;
+    uint32_t pad;
+};
+static_assert(sizeof(GpuParticle) == 32);
+
+constexpr uint32_t GPU_GROUP_SIZE = 256;
+
+const char* particle_struct_glsl =
+R"(struct Particle
+{
+    vec2 position;
+    vec2 velocity;
+    float life;
+    float inverse_life;
+    uint color;
+    uint pad;
+};
+)";
+
+// Spawns into the spawn_count slots from spawn_start, wrapping at capacity, and integrates
+// every other live slot below used exactly as ParticleSystem::Emitter::Integrate does.
+const char* simulate_cs =
+R"(
+layout (local_size_x = 256) in;
+layout (std430, binding = 0) buffer Particles
+{
+    Particle particles[];
+};
+
+uniform uint capacity;
+uniform uint used;
+uniform uint spawn_start;
+uniform uint spawn_count;
+uniform uint spawn_index;
+uniform uint seed;
+uniform float dt;
+uniform float damping;
+uniform vec2 gravity;
+uniform vec2 origin;
+uniform vec2 spawn_size;
+uniform vec2 life_range;
+uniform vec2 speed_range;
+uniform float direction;
+uniform float spread;
+uniform vec4 color_start;
+uniform vec4 color_end;
+
+uint Hash(uint x)
+{
+    uint state = x * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+float RandomRange(uint n, uint k, float low, float high)
+{
+    return low + (high - low) * float(Hash(seed + n * 6u + k) >> 8u) * (1.0 / 16777216.0);
+}
+
+void main()
+{
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= used)
+        return;
+
+    Particle p = particles[i];
+    uint age = (i + capacity - spawn_start) % capacity;
+    if (age < spawn_count)
+    {
+        uint n = spawn_index + age;
+        float angle = direction + RandomRange(n, 0u, -0.5, 0.5) * spread;
+        float speed = RandomRange(n, 1u, speed_range.x, speed_range.y);
+        float life = max(RandomRange(n, 2u, life_range.x, life_range.y), 1e-4);
+        p.position = origin + vec2(RandomRange(n, 3u, -0.5, 0.5), RandomRange(n, 4u, -0.5, 0.5)) * spawn_size;
+        p.velocity = vec2(cos(angle), sin(angle)) * speed;
+        p.life = life;
+        p.inverse_life = 1.0 / life;
+        p.color = packUnorm4x8(color_start);
+    }
+    else if (p.life > 0.0)
+    {
+        p.life -= dt;
+        p.velocity = (p.velocity + gravity * dt) * damping;
+        p.position += p.velocity * dt;
+        float t = 1.0 - max(p.life, 0.0) * p.inverse_life;
+        p.color = packUnorm4x8(mix(color_start, color_end, t));
+    }
+    else
+    {
+        return;
+    }
+    particles[i] = p;
+}
+)";
+
+// One instance per slot; dead slots are moved outside the clip volume.
+const char* particle_vs =
+R"(
+layout (location = 0) in vec2 position;
+layout (std430, binding = 0) readonly buffer Particles
+{
+    Particle particles[];
+};
+out vec2 texture_coords;
+out vec4 tint;
+uniform mat4 m;
+uniform mat4 vp;
+uniform vec2 uv_start;
+uniform vec2 uv_end;
+void main()
+{
+    Particle p = particles[gl_InstanceID];
+    texture_coords = mix(uv_start, uv_end, position + 0.5);
+    tint = unpackUnorm4x8(p.color);
+    if (p.life > 0.0)
+        gl_Position = vp * (m * vec4(position, 0.0, 1.0) + vec4(p.position, 0.0, 0.0));
+    else
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+}
+)";
+
+const char* particle_fs =
+R"(#version 450 core
+in vec2 texture_coords;
+in vec4 tint;
+uniform sampler2D tex;
+uniform bool textured;
+out vec4 fragment_color;
+void main()
+{
+    fragment_color = textured ? texture(tex, texture_coords) * tint : tint;
+})";
+
+const float quad_vertices[] = {
+    -0.5f, 0.5f,
+    -0.5f, -0.5f,
+    0.5f, -0.5f,
+
+    0.5f, -0.5f,
+    0.5f, 0.5f,
+    -0.5f, 0.5f,
+};
+
+bool gpu_initialized = false;
+bifrost::Shader simulate_shader{};
+bifrost::Shader particle_shader{};
+unsigned int quad_vao = 0;
+
+void InitializeGpu()
+{
+    if (gpu_initialized)
+        return;
+
+    gpu_initialized = true;
+
+    std::string header = std::string("#version 450 core\n") + particle_struct_glsl;
+    simulate_shader = bifrost::GenComputeShaderFromSource((header + simulate_cs).c_str());
+    particle_shader = bifrost::GenShaderFromSource((header + particle_vs).c_str(), particle_fs);
+    quad_vao = bifrost::GenVec2Vao(quad_vertices, 6);
+}
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+struct ParticleSystem::Emitter
+{
+    EmitterParams params;
+    size_t capacity = 0;
+    size_t count = 0;                   // Gpu: slots in use, live or not
+    float spawn_accumulator = 0.0f;
+    uint32_t seed = 0;
+    uint32_t spawned = 0;               // spawn index of the next particle
+
+    // Gpu only: the particle buffer and the slot the next spawn goes in.
+    unsigned int buffer = 0;
+    size_t ring_head = 0;
+
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;
+    std::vector<float> life;            // seconds left
+    std::vector<float> inverse_life;    // 1 / starting life
+
+    // Instance data for the draw, written by the update.
+    std::vector<glm::vec2> offsets;
+    std::vector<uint32_t> colors;
+
+    void Resize(size_t capacity)
+    {
+        for (auto* array : {&x, &y, &vx, &vy, &life, &inverse_life})
+            array->resize(capacity);
+        offsets.resize(capacity);
+        colors.resize(capacity);
+    }
+
+    void Move(size_t from, size_t to)
+    {
+        x[to] = x[from];
+        y[to] = y[from];
+        vx[to] = vx[from];
+        vy[to] = vy[from];
+        life[to] = life[from];
+        inverse_life[to] = inverse_life[from];
+        offsets[to] = offsets[from];
+        colors[to] = colors[from];
+    }
+
+    // Integrates [begin, end) and writes their instance data. Touches nothing outside the
+    // range, so disjoint ranges can run on different threads.
+    void Integrate(size_t begin, size_t end, float dt);
+
+    // Gpu: spawns count particles and integrates the rest in one dispatch.
+    void Simulate(float dt, uint32_t spawn_count);
+
+    ~Emitter()
+    {
+        if (buffer)
+            glDeleteBuffers(1, &buffer);
+    }
+};
+
+void ParticleSystem::Emitter::Integrate(size_t begin, size_t end, float dt)
+{
+    float* px = x.data();
+    float* py = y.data();
+    float* pvx = vx.data();
+    float* pvy = vy.data();
+    float* plife = life.data();
+    const float* pinverse = inverse_life.data();
+    float* poffsets = &offsets.data()->x;
+    uint32_t* pcolors = colors.data();
+
+    const float damping = std::max(0.0f, 1.0f - params.drag * dt);
+    const glm::vec2 gravity = params.gravity * dt;
+    const glm::vec4 start = params.color_start * 255.0f;
+    const glm::vec4 delta = (params.color_end - params.color_start) * 255.0f;
+
+    size_t i = begin;
+#ifdef BIFROST_PARTICLES_SSE2
+    const __m128 v_dt = _mm_set1_ps(dt);
+    const __m128 v_damping = _mm_set1_ps(damping);
+    const __m128 v_gravity_x = _mm_set1_ps(gravity.x);
+    const __m128 v_gravity_y = _mm_set1_ps(gravity.y);
+    const __m128 v_zero = _mm_setzero_ps();
+    const __m128 v_one = _mm_set1_ps(1.0f);
+    const __m128 v_max = _mm_set1_ps(255.0f);
+    const __m128 v_start[4] = {_mm_set1_ps(start.r), _mm_set1_ps(start.g), _mm_set1_ps(start.b), _mm_set1_ps(start.a)};
+    const __m128 v_delta[4] = {_mm_set1_ps(delta.r), _mm_set1_ps(delta.g), _mm_set1_ps(delta.b), _mm_set1_ps(delta.a)};
+
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 life4 = _mm_sub_ps(_mm_loadu_ps(plife + i), v_dt);
+        __m128 vx4 = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(pvx + i), v_gravity_x), v_damping);
+        __m128 vy4 = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(pvy + i), v_gravity_y), v_damping);
+        __m128 x4 = _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(vx4, v_dt));
+        __m128 y4 = _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(vy4, v_dt));
+        _mm_storeu_ps(plife + i, life4);
+        _mm_storeu_ps(pvx + i, vx4);
+        _mm_storeu_ps(pvy + i, vy4);
+        _mm_storeu_ps(px + i, x4);
+        _mm_storeu_ps(py + i, y4);
+
+        // Interleave x and y into the vec2 offsets.
+        _mm_storeu_ps(poffsets + i * 2, _mm_unpacklo_ps(x4, y4));
+        _mm_storeu_ps(poffsets + i * 2 + 4, _mm_unpackhi_ps(x4, y4));
+
+        // t runs from 0 at birth to 1 at death; each channel is clamped to [0, 255] as float
+        // so the packing below can't carry into its neighbour.
+        __m128 t = _mm_sub_ps(v_one, _mm_mul_ps(_mm_max_ps(life4, v_zero), _mm_loadu_ps(pinverse + i)));
+        __m128i rgba = _mm_setzero_si128();
+        for (int c = 0; c < 4; c++)
+        {
+            __m128 channel = _mm_add_ps(v_start[c], _mm_mul_ps(v_delta[c], t));
+            channel = _mm_min_ps(_mm_max_ps(channel, v_zero), v_max);
+            rgba = _mm_or_si128(rgba, _mm_slli_epi32(_mm_cvtps_epi32(channel), c * 8));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pcolors + i), rgba);
+    }
+#endif
+
+    for (; i < end; i++)
+    {
+        plife[i] -= dt;
+        pvx[i] = (pvx[i] + gravity.x) * damping;
+        pvy[i] = (pvy[i] + gravity.y) * damping;
+        px[i] += pvx[i] * dt;
+        py[i] += pvy[i] * dt;
+        poffsets[i * 2] = px[i];
+        poffsets[i * 2 + 1] = py[i];
+        float t = 1.0f - std::max(plife[i], 0.0f) * pinverse[i];
+        pcolors[i] = PackColor(params.color_start, params.color_end, t);
+    }
+}
+
+void ParticleSystem::Emitter::Simulate(float dt, uint32_t spawn_count)
+{
+    // A spawn bigger than the buffer only keeps its newest particles.
+    uint32_t kept = (uint32_t)std::min<size_t>(spawn_count, capacity);
+    uint32_t spawn_index = spawned + spawn_count - kept;
+    size_t spawn_start = ring_head;
+    spawned += spawn_count;
+    ring_head = (ring_head + kept) % std::max<size_t>(capacity, 1);
+    count = std::min(count + kept, capacity);
+
+    if (count == 0 || simulate_shader.id == 0)
+        return;
+
+    unsigned int id = simulate_shader.id;
+    glUseProgram(id);
+    glUniform1ui(glGetUniformLocation(id, "capacity"), (uint32_t)capacity);
+    glUniform1ui(glGetUniformLocation(id, "used"), (uint32_t)count);
+    glUniform1ui(glGetUniformLocation(id, "spawn_start"), (uint32_t)spawn_start);
+    glUniform1ui(glGetUniformLocation(id, "spawn_count"), kept);
+    glUniform1ui(glGetUniformLocation(id, "spawn_index"), spawn_index);
+    glUniform1ui(glGetUniformLocation(id, "seed"), seed);
+    glUniform1f(glGetUniformLocation(id, "dt"), dt);
+    glUniform1f(glGetUniformLocation(id, "damping"), std::max(0.0f, 1.0f - params.drag * dt));
+    glUniform2fv(glGetUniformLocation(id, "gravity"), 1, glm::value_ptr(params.gravity));
+    glUniform2fv(glGetUniformLocation(id, "origin"), 1, glm::value_ptr(params.position));
+    glUniform2fv(glGetUniformLocation(id, "spawn_size"), 1, glm::value_ptr(params.spawn_size));
+    glUniform2f(glGetUniformLocation(id, "life_range"), params.life_min, params.life_max);
+    glUniform2f(glGetUniformLocation(id, "speed_range"), params.speed_min, params.speed_max);
+    glUniform1f(glGetUniformLocation(id, "direction"), params.direction);
+    glUniform1f(glGetUniformLocation(id, "spread"), params.spread);
+    glUniform4fv(glGetUniformLocation(id, "color_start"), 1, glm::value_ptr(params.color_start));
+    glUniform4fv(glGetUniformLocation(id, "color_end"), 1, glm::value_ptr(params.color_end));
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer);
+    glDispatchCompute((uint32_t)((count + GPU_GROUP_SIZE - 1) / GPU_GROUP_SIZE), 1, 1);
+    // Covers both the draw's reads and GetParticlePositions' readback.
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+ParticleSystem::ParticleSystem(JobSystem* jobs)
+    : jobs_(jobs ? jobs : &GetJobSystem())
+{
+}
+
+ParticleSystem::~ParticleSystem() = default;
+
+EmitterId ParticleSystem::AddEmitter(const EmitterParams& params)
+{
+    auto emitter = std::make_unique<Emitter>();
+    emitter->params = params;
+    emitter->capacity = params.max_particles;
+    if (params.backend == ParticleBackend::Gpu)
+    {
+        InitializeGpu();
+        if (emitter->capacity > 0)
+        {
+            glCreateBuffers(1, &emitter->buffer);
+            glNamedBufferData(emitter->buffer, sizeof(GpuParticle) * emitter->capacity, nullptr, GL_DYNAMIC_COPY);
+            glClearNamedBufferData(emitter->buffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+        }
+    }
+    else
+    {
+        emitter->Resize(params.max_particles);
+    }
+
+    uint32_t index;
+    if (!free_slots_.empty())
+    {
+        index = free_slots_.back();
+        free_slots_.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)emitters_.size();
+        emitters_.emplace_back();
+        generations_.push_back(1);
+    }
+    emitter->seed = params.seed ? params.seed : Hash(index + 1);
+    emitters_[index] = std::move(emitter);
+    return EmitterId{index, generations_[index]};
+}
+
+void ParticleSystem::RemoveEmitter(EmitterId id)
+{
+    if (!Find(id))
+        return;
+    emitters_[id.index].reset();
+    generations_[id.index]++;
+    free_slots_.push_back(id.index);
+}
+
+EmitterParams* ParticleSystem::GetParams(EmitterId id)
+{
+    Emitter* emitter = Find(id);
+    return emitter ? &emitter->params : nullptr;
+}
+
+void ParticleSystem::Burst(EmitterId id, uint32_t count)
+{
+    Emitter* emitter = Find(id);
+    if (!emitter)
+        return;
+    // A Gpu burst is a dispatch that doesn't advance time, so the new particles are in the
+    // buffer before the next update moves them, same as on the Cpu.
+    if (emitter->buffer)
+        emitter->Simulate(0.0f, count);
+    else
+        Spawn(*emitter, count);
+}
+
+void ParticleSystem::Clear(EmitterId id)
+{
+    Emitter* emitter = Find(id);
+    if (!emitter)
+        return;
+    emitter->count = 0;
+    emitter->ring_head = 0;
+    if (emitter->buffer)
+        glClearNamedBufferData(emitter->buffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+}
+
+size_t ParticleSystem::GetParticleCount(EmitterId id) const
+{
+    const Emitter* emitter = Find(id);
+    return emitter ? emitter->count : 0;
+}
+
+void ParticleSystem::GetParticlePositions(EmitterId id, std::vector<glm::vec2>& positions) const
+{
+    positions.clear();
+    const Emitter* found = Find(id);
+    if (!found)
+        return;
+    const Emitter& emitter = *found;
+
+    if (!emitter.buffer)
+    {
+        positions.assign(emitter.offsets.begin(), emitter.offsets.begin() + emitter.count);
+        return;
+    }
+
+    std::vector<GpuParticle> particles(emitter.count);
+    glGetNamedBufferSubData(emitter.buffer, 0, sizeof(GpuParticle) * particles.size(), particles.data());
+    for (const GpuParticle& particle : particles)
+    {
+        if (particle.life > 0.0f)
+            positions.push_back(particle.position);
+    }
+}
+
+void ParticleSystem::Spawn(Emitter& emitter, uint32_t count)
+{
+    const EmitterParams& params = emitter.params;
+    uint32_t color = PackColor(params.color_start, params.color_end, 0.0f);
+
+    for (uint32_t spawned = 0; spawned < count && emitter.count < emitter.capacity; spawned++)
+    {
+        size_t i = emitter.count++;
+        uint32_t n = emitter.spawned++;
+        float angle = params.direction + RandomRange(emitter.seed, n, 0, -0.5f, 0.5f) * params.spread;
+        float speed = RandomRange(emitter.seed, n, 1, params.speed_min, params.speed_max);
+        float life = std::max(RandomRange(emitter.seed, n, 2, params.life_min, params.life_max), 1e-4f);
+
+        emitter.x[i] = params.position.x + RandomRange(emitter.seed, n, 3, -0.5f, 0.5f) * params.spawn_size.x;
+        emitter.y[i] = params.position.y + RandomRange(emitter.seed, n, 4, -0.5f, 0.5f) * params.spawn_size.y;
+        emitter.vx[i] = std::cos(angle) * speed;
+        emitter.vy[i] = std::sin(angle) * speed;
+        emitter.life[i] = life;
+        emitter.inverse_life[i] = 1.0f / life;
+        emitter.offsets[i] = {emitter.x[i], emitter.y[i]};
+        emitter.colors[i] = color;
+    }
+}
+
+void ParticleSystem::Update(float dt)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto& emitter_ptr : emitters_)
+    {
+        if (!emitter_ptr)
+            continue;
+        Emitter& emitter = *emitter_ptr;
+
+        emitter.spawn_accumulator += emitter.params.rate * dt;
+        uint32_t spawn_count = (uint32_t)emitter.spawn_accumulator;
+        emitter.spawn_accumulator -= (float)spawn_count;
+
+        if (emitter.buffer)
+        {
+            emitter.Simulate(dt, spawn_count);
+            continue;
+        }
+
+        if (emitter.count >= PARALLEL_THRESHOLD)
+        {
+            jobs_->ParallelFor(emitter.count, [&emitter, dt](size_t begin, size_t end) {
+                emitter.Integrate(begin, end, dt);
+            }, PARALLEL_THRESHOLD / 4);
+        }
+        else
+        {
+            emitter.Integrate(0, emitter.count, dt);
+        }
+
+        // Swap the dead out for the last live particle, so the live ones stay packed at the
+        // front for the next update and the draw.
+        for (size_t i = 0; i < emitter.count;)
+        {
+            if (emitter.life[i] > 0.0f)
+            {
+                i++;
+                continue;
+            }
+            emitter.count--;
+            emitter.Move(emitter.count, i);
+        }
+
+        Spawn(emitter, spawn_count);
+    }
+
+    update_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ParticleSystem::Draw(const Camera2d& camera) const
+{
+    for (const auto& emitter_ptr : emitters_)
+    {
+        if (!emitter_ptr || emitter_ptr->count == 0)
+            continue;
+        const Emitter& emitter = *emitter_ptr;
+        const EmitterParams& params = emitter.params;
+
+        glm::vec2 source_size = params.source_size;
+        if (source_size == glm::vec2(0.0f))
+            source_size = glm::vec2((float)params.texture.width, (float)params.texture.height);
+
+        if (params.additive)
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+
+        if (!emitter.buffer)
+        {
+            DrawRectangleInstanced(camera, glm::vec2(0.0f), params.particle_size, params.texture, params.source_origin, source_size,
+                                   std::span(emitter.offsets.data(), emitter.count), std::span(emitter.colors.data(), emitter.count));
+        }
+        else if (particle_shader.id != 0)
+        {
+            bool textured = params.texture.id != 0;
+            glm::vec2 uv_start{0.0f}, uv_end{1.0f};
+            if (textured)
+            {
+                glm::vec2 texture_size = glm::vec2((float)params.texture.width, (float)params.texture.height);
+                uv_start = params.source_origin / texture_size;
+                uv_end = uv_start + source_size / texture_size;
+            }
+            auto model = glm::scale(glm::mat4(1.0f), glm::vec3(params.particle_size.x, params.particle_size.y, 1.0f));
+
+            glDisable(GL_DEPTH_TEST);
+            glBindVertexArray(quad_vao);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, emitter.buffer);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, params.texture.id);
+
+            unsigned int id = particle_shader.id;
+            glUseProgram(id);
+            glUniformMatrix4fv(glGetUniformLocation(id, "m"), 1, GL_FALSE, glm::value_ptr(model));
+            glUniformMatrix4fv(glGetUniformLocation(id, "vp"), 1, GL_FALSE, glm::value_ptr(camera.projection));
+            glUniform2fv(glGetUniformLocation(id, "uv_start"), 1, glm::value_ptr(uv_start));
+            glUniform2fv(glGetUniformLocation(id, "uv_end"), 1, glm::value_ptr(uv_end));
+            glUniform1i(glGetUniformLocation(id, "textured"), textured);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (int)emitter.count);
+
+            glBindVertexArray(0);
+        }
+
+        if (params.additive)
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+}
+
+ParticleStats ParticleSystem::GetStats() const
+{
+    ParticleStats stats{0, 0, update_ms_};
+    for (const auto& emitter : emitters_)
+    {
+        if (!emitter)
+            continue;
+        stats.emitters++;
+        stats.particles += emitter->count;
+    }
+    return stats;
+}
+
+ParticleSystem::Emitter* ParticleSystem::Find(EmitterId id) const
+{
+    if (id.index >= emitters_.size() || generations_[id.index] != id.generation)
+        return nullptr;
+    return emitters_[id.index].get();
+}
+
+} // namespace bifrost
@@ -0,0 +1,464 @@
+#include "bifrost_pathfinding.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace
+{
+
+const glm::ivec2 neighbour_offsets[8] = {
+    { 1,  0}, {-1,  0}, { 0,  1}, { 0, -1},
+    { 1,  1}, {-1,  1}, { 1, -1}, {-1, -1},
+};
+
+constexpr uint32_t unreachable = std::numeric_limits<uint32_t>::max();
+
+// Same test as !IsTileSolid, but visible to the optimizer: searches call it hundreds of
+// thousands of times per path.
+inline bool IsOpen(const bifrost::TileCollisionGrid& grid, int x, int y)
+{
+    if ((unsigned)x >= (unsigned)grid.width || (unsigned)y >= (unsigned)grid.height)
+        return false;
+    size_t bit = (size_t)y * grid.width + x;
+    return !((grid.solid[bit >> 6] >> (bit & 63)) & 1);
+}
+
+bool CanStep(const bifrost::TileCollisionGrid& grid, int x, int y, int dx, int dy)
+{
+    if (!IsOpen(grid, x + dx, y + dy))
+        return false;
+    if (dx && dy)
+        return IsOpen(grid, x + dx, y) && IsOpen(grid, x, y + dy);
+    return true;
+}
+
+float Octile(glm::ivec2 a, glm::ivec2 b)
+{
+    int dx = std::abs(a.x - b.x);
+    int dy = std::abs(a.y - b.y);
+    return (float)std::max(dx, dy) + 0.41421356f * (float)std::min(dx, dy);
+}
+
+// Per-thread search state, reused between searches. Entries are valid only when their
+// stamp matches the current search, so nothing has to be cleared between runs.
+struct SearchScratch
+{
+    std::vector<float> g;
+    std::vector<int> parent;
+    std::vector<uint32_t> stamp;
+    std::vector<uint8_t> closed;
+    uint32_t search = 0;
+
+    void Begin(size_t cell_count)
+    {
+        if (g.size() != cell_count)
+        {
+            g.assign(cell_count, 0.0f);
+            parent.assign(cell_count, -1);
+            stamp.assign(cell_count, 0);
+            closed.assign(cell_count, 0);
+            search = 0;
+        }
+        search++;
+        if (search == 0)
+        {
+            std::fill(stamp.begin(), stamp.end(), 0);
+            search = 1;
+        }
+    }
+};
+
+thread_local SearchScratch scratch{};
+
+// Jump from (x, y), which was reached by stepping (dx, dy), until a jump point, the goal or
+// a dead end. Straight runs are walked in a loop; diagonal runs probe both straight
+// components at every step.
+bool Jump(const bifrost::TileCollisionGrid& grid, int x, int y, int dx, int dy, glm::ivec2 goal, glm::ivec2& out)
+{
+    while (true)
+    {
+        if (!IsOpen(grid, x, y))
+            return false;
+
+        if (x == goal.x && y == goal.y)
+        {
+            out = {x, y};
+            return true;
+        }
+
+        if (dx && dy)
+        {
+            glm::ivec2 unused;
+            if (Jump(grid, x + dx, y, dx, 0, goal, unused) || Jump(grid, x, y + dy, 0, dy, goal, unused))
+            {
+                out = {x, y};
+                return true;
+            }
+        }
+        else if (dx)
+        {
+            if ((IsOpen(grid, x, y - 1) && !IsOpen(grid, x - dx, y - 1)) ||
+                (IsOpen(grid, x, y + 1) && !IsOpen(grid, x - dx, y + 1)))
+            {
+                out = {x, y};
+                return true;
+            }
+        }
+        else
+        {
+            if ((IsOpen(grid, x - 1, y) && !IsOpen(grid, x - 1, y - dy)) ||
+                (IsOpen(grid, x + 1, y) && !IsOpen(grid, x + 1, y - dy)))
+            {
+                out = {x, y};
+                return true;
+            }
+        }
+
+        if (!IsOpen(grid, x + dx, y) || !IsOpen(grid, x, y + dy))
+            return false;
+
+        x += dx;
+        y += dy;
+    }
+}
+
+// Directions worth exploring from a node reached along (dx, dy); all open ones at the start.
+int PrunedNeighbours(const bifrost::TileCollisionGrid& grid, int x, int y, int dx, int dy, glm::ivec2 (&out)[8])
+{
+    int count = 0;
+    if (!dx && !dy)
+    {
+        for (const auto& o : neighbour_offsets)
+            if (CanStep(grid, x, y, o.x, o.y))
+                out[count++] = o;
+        return count;
+    }
+
+    if (dx && dy)
+    {
+        bool vertical = IsOpen(grid, x, y + dy);
+        bool horizontal = IsOpen(grid, x + dx, y);
+        if (vertical)
+            out[count++] = {0, dy};
+        if (horizontal)
+            out[count++] = {dx, 0};
+        if (vertical && horizontal)
+            out[count++] = {dx, dy};
+        return count;
+    }
+
+    // Straight move: continue ahead, and turn towards either side that is open.
+    glm::ivec2 ahead = {dx, dy};
+    glm::ivec2 side = {dy != 0 ? 1 : 0, dx != 0 ? 1 : 0};
+    bool next = IsOpen(grid, x + ahead.x, y + ahead.y);
+    bool positive = IsOpen(grid, x + side.x, y + side.y);
+    bool negative = IsOpen(grid, x - side.x, y - side.y);
+    if (next)
+    {
+        out[count++] = ahead;
+        if (positive)
+            out[count++] = ahead + side;
+        if (negative)
+            out[count++] = ahead - side;
+    }
+    if (positive)
+        out[count++] = side;
+    if (negative)
+        out[count++] = -side;
+    return count;
+}
+
+uint64_t GoalKey(glm::ivec2 goal)
+{
+    return ((uint64_t)(uint32_t)goal.x << 32) | (uint32_t)goal.y;
+}
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+std::vector<glm::ivec2> FindPath(const TileCollisionGrid& grid, glm::ivec2 start, glm::ivec2 goal)
+{
+    if (!IsOpen(grid, start.x, start.y) || !IsOpen(grid, goal.x, goal.y))
+        return {};
+    if (start == goal)
+        return {start};
+
+    auto& s = scratch;
+    s.Begin((size_t)grid.width * grid.height);
+
+    auto index = [&grid](glm::ivec2 p) { return p.y * grid.width + p.x; };
+
+    using OpenEntry = std::pair<float, int>;
+    std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> open{};
+
+    int start_index = index(start);
+    s.stamp[start_index] = s.search;
+    s.g[start_index] = 0.0f;
+    s.parent[start_index] = -1;
+    s.closed[start_index] = 0;
+    open.push({Octile(start, goal), start_index});
+
+    int goal_index = index(goal);
+    while (!open.empty())
+    {
+        int current = open.top().second;
+        open.pop();
+        if (s.closed[current])
+            continue;
+        s.closed[current] = 1;
+
+        if (current == goal_index)
+            break;
+
+        glm::ivec2 p = {current % grid.width, current / grid.width};
+        glm::ivec2 d{0};
+        if (s.parent[current] >= 0)
+        {
+            glm::ivec2 from = {s.parent[current] % grid.width, s.parent[current] / grid.width};
+            d = glm::clamp(p - from, glm::ivec2(-1), glm::ivec2(1));
+        }
+
+        glm::ivec2 directions[8];
+        int count = PrunedNeighbours(grid, p.x, p.y, d.x, d.y, directions);
+        for (int i = 0; i < count; i++)
+        {
+            glm::ivec2 jump_point;
+            if (!Jump(grid, p.x + directions[i].x, p.y + directions[i].y, directions[i].x, directions[i].y, goal, jump_point))
+                continue;
+
+            int next = index(jump_point);
+            float g = s.g[current] + Octile(p, jump_point);
+            if (s.stamp[next] == s.search && (s.closed[next] || g >= s.g[next]))
+                continue;
+
+            s.stamp[next] = s.search;
+            s.closed[next] = 0;
+            s.g[next] = g;
+            s.parent[next] = current;
+            open.push({g + Octile(jump_point, goal), next});
+        }
+    }
+
+    if (s.stamp[goal_index] != s.search)
+        return {};
+
+    std::vector<glm::ivec2> path{};
+    for (int i = goal_index; i >= 0; i = s.parent[i])
+        path.push_back({i % grid.width, i / grid.width});
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+FlowField GenFlowField(const TileCollisionGrid& grid, glm::ivec2 goal)
+{
+    FlowField field = {};
+    field.width = grid.width;
+    field.height = grid.height;
+    field.goal = goal;
+    field.distance.assign((size_t)grid.width * grid.height, unreachable);
+    field.direction.assign((size_t)grid.width * grid.height, 0xFF);
+
+    if (!IsOpen(grid, goal.x, goal.y))
+        return field;
+
+    // Dial's algorithm: edge costs are 10 or 14, so a ring of 15 buckets holds every
+    // distance that can still be pending.
+    constexpr int bucket_count = 15;
+    std::vector<int> buckets[bucket_count];
+    uint32_t current_distance = 0;
+    size_t pending = 1;
+
+    field.distance[(size_t)goal.y * grid.width + goal.x] = 0;
+    buckets[0].push_back(goal.y * grid.width + goal.x);
+
+    while (pending)
+    {
+        auto& bucket = buckets[current_distance % bucket_count];
+        while (!bucket.empty())
+        {
+            int cell = bucket.back();
+            bucket.pop_back();
+            pending--;
+            if (field.distance[cell] != current_distance)
+                continue;
+
+            int x = cell % grid.width;
+            int y = cell / grid.width;
+            for (int i = 0; i < 8; i++)
+            {
+                const auto& o = neighbour_offsets[i];
+                if (!CanStep(grid, x, y, o.x, o.y))
+                    continue;
+                int next = (y + o.y) * grid.width + x + o.x;
+                uint32_t distance = current_distance + (i < 4 ? 10 : 14);
+                if (distance >= field.distance[next])
+                    continue;
+                field.distance[next] = distance;
+                buckets[distance % bucket_count].push_back(next);
+                pending++;
+            }
+        }
+        current_distance++;
+    }
+
+    // Point every reachable cell at its cheapest neighbour. Steps are symmetric, so the
+    // same corner-cutting rule applies in this direction.
+    for (int y = 0; y < grid.height; y++)
+    {
+        for (int x = 0; x < grid.width; x++)
+        {
+            size_t cell = (size_t)y * grid.width + x;
+            uint32_t best = field.distance[cell];
+            if (best == unreachable || best == 0)
+                continue;
+            for (int i = 0; i < 8; i++)
+            {
+                const auto& o = neighbour_offsets[i];
+                if (!CanStep(grid, x, y, o.x, o.y))
+                    continue;
+                uint32_t d = field.distance[(size_t)(y + o.y) * grid.width + x + o.x];
+                if (d < best)
+                {
+                    best = d;
+                    field.direction[cell] = (uint8_t)i;
+                }
+            }
+        }
+    }
+
+    return field;
+}
+
+glm::vec2 GetFlowDirection(const FlowField& field, glm::ivec2 tile)
+{
+    if (tile.x < 0 || tile.y < 0 || tile.x >= field.width || tile.y >= field.height)
+        return glm::vec2(0.0f);
+    uint8_t direction = field.direction[(size_t)tile.y * field.width + tile.x];
+    if (direction == 0xFF)
+        return glm::vec2(0.0f);
+    return glm::normalize(glm::vec2(neighbour_offsets[direction]));
+}
+
+PathfindingService::PathfindingService(const TileCollisionGrid& grid, JobSystem& jobs, int max_paths_per_update, size_t max_cached_fields)
+    : grid_(grid)
+    , jobs_(jobs)
+    , max_paths_per_update_(max_paths_per_update)
+    , max_cached_fields_(max_cached_fields)
+{
+}
+
+PathfindingService::~PathfindingService()
+{
+    jobs_.Wait(in_flight_);
+}
+
+uint32_t PathfindingService::RequestPath(glm::ivec2 start, glm::ivec2 goal)
+{
+    uint32_t id = next_request_++;
+    if (next_request_ == 0)
+        next_request_ = 1;
+    queued_.push_back({id, start, goal});
+    return id;
+}
+
+bool PathfindingService::GetPath(uint32_t request, std::vector<glm::ivec2>& out)
+{
+    std::lock_guard lock(mutex_);
+    auto it = results_.find(request);
+    if (it == results_.end())
+        return false;
+    out = std::move(it->second);
+    results_.erase(it);
+    return true;
+}
+
+std::shared_ptr<const FlowField> PathfindingService::GetFlowField(glm::ivec2 goal)
+{
+    std::unique_lock lock(mutex_);
+    uint64_t key = GoalKey(goal);
+    auto it = fields_.find(key);
+    if (it != fields_.end())
+    {
+        it->second.last_used = frame_;
+        return it->second.field;
+    }
+
+    // Evict the least recently used finished field to stay within the cache size.
+    if (fields_.size() >= max_cached_fields_)
+    {
+        auto oldest = fields_.end();
+        for (auto f = fields_.begin(); f != fields_.end(); ++f)
+            if (f->second.field && (oldest == fields_.end() || f->second.last_used < oldest->second.last_used))
+                oldest = f;
+        if (oldest != fields_.end())
+            fields_.erase(oldest);
+    }
+
+    uint64_t generation = field_generation_;
+    fields_[key] = CachedField{nullptr, frame_, generation};
+    lock.unlock();
+
+    jobs_.Run([this, goal, generation]() { RunField(goal, generation); }, &in_flight_);
+    return nullptr;
+}
+
+void PathfindingService::InvalidateFlowFields()
+{
+    std::lock_guard lock(mutex_);
+    field_generation_++;
+    fields_.clear();
+}
+
+void PathfindingService::Update()
+{
+    frame_++;
+    if (queued_.empty())
+        return;
+
+    // Hand out this frame's share of the queue in batches, so each job takes one lock per
+    // batch rather than per path.
+    size_t count = std::min(queued_.size(), (size_t)max_paths_per_update_);
+    size_t batch_size = std::max<size_t>(1, count / ((size_t)(jobs_.WorkerCount() + 1) * 2));
+    for (size_t begin = 0; begin < count; begin += batch_size)
+    {
+        size_t end = std::min(count, begin + batch_size);
+        std::vector<PathRequest> batch(queued_.begin() + begin, queued_.begin() + end);
+        jobs_.Run([this, batch = std::move(batch)]() { RunPaths(batch); }, &in_flight_);
+    }
+    queued_.erase(queued_.begin(), queued_.begin() + count);
+}
+
+void PathfindingService::Flush()
+{
+    while (!queued_.empty())
+        Update();
+    jobs_.Wait(in_flight_);
+}
+
+void PathfindingService::RunPaths(const std::vector<PathRequest>& paths)
+{
+    std::vector<std::pair<uint32_t, std::vector<glm::ivec2>>> found{};
+    found.reserve(paths.size());
+    for (const auto& request : paths)
+        found.push_back({request.id, FindPath(grid_, request.start, request.goal)});
+
+    std::lock_guard lock(mutex_);
+    for (auto& [id, path] : found)
+        results_[id] = std::move(path);
+}
+
+void PathfindingService::RunField(glm::ivec2 goal, uint64_t generation)
+{
+    auto field = std::make_shared<const FlowField>(GenFlowField(grid_, goal));
+
+    std::lock_guard lock(mutex_);
+    auto it = fields_.find(GoalKey(goal));
+    if (it != fields_.end() && it->second.generation == generation)
+        it->second.field = std::move(field);
+}
+
+} // namespace bifrost
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "bifrost.h"
+#include "bifrost_collision.h"
+#include "bifrost_jobs.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace bifrost
+{
+    // All searches run over the non-solid tiles of a TileCollisionGrid, 8-connected, with
+    // diagonal steps only allowed when both adjacent orthogonal tiles are open.
+
+    // A* with Jump Point Search. Returns the jump points from start to goal (inclusive);
+    // consecutive points are joined by straight or 45 degree runs of open tiles. Empty if
+    // there is no path.
+    std::vector<glm::ivec2> FindPath(const TileCollisionGrid& grid, glm::ivec2 start, glm::ivec2 goal);
+
+    // Distance-to-goal field shared by every agent heading for the same tile.
+    struct FlowField
+    {
+        int width;
+        int height;
+        glm::ivec2 goal;
+        std::vector<uint32_t> distance;   // 10 per straight step, 14 per diagonal; UINT32_MAX if unreachable
+        std::vector<uint8_t> direction;   // index into the 8 neighbour offsets, 0xFF at the goal or if unreachable
+    };
+
+    FlowField GenFlowField(const TileCollisionGrid& grid, glm::ivec2 goal);
+    // Unit step towards the goal from tile, or zero if the tile is the goal or unreachable.
+    glm::vec2 GetFlowDirection(const FlowField& field, glm::ivec2 tile);
+
+    // Runs path and flow field requests as jobs. Requests are queued and handed to the
+    // job system in batches from Update(), at most max_paths_per_update per call, so a
+    // burst of requests is spread over several frames. Flow fields are cached per goal.
+    // The grid must outlive the service and must not change while work is in flight; call
+    // Flush() before editing it and InvalidateFlowFields() afterwards.
+    class PathfindingService
+    {
+    public:
+        PathfindingService(const TileCollisionGrid& grid, JobSystem& jobs = GetJobSystem(), int max_paths_per_update = 256, size_t max_cached_fields = 16);
+        ~PathfindingService();
+
+        PathfindingService(const PathfindingService&) = delete;
+        PathfindingService& operator=(const PathfindingService&) = delete;
+
+        uint32_t RequestPath(glm::ivec2 start, glm::ivec2 goal);
+        // Returns true and moves the path into out once the request has completed.
+        bool GetPath(uint32_t request, std::vector<glm::ivec2>& out);
+
+        // Returns the cached field for goal, or nullptr while it is being built.
+        std::shared_ptr<const FlowField> GetFlowField(glm::ivec2 goal);
+        void InvalidateFlowFields();
+
+        void Update();
+        // Blocks until every queued and in-flight request has completed.
+        void Flush();
+
+    private:
+        struct PathRequest
+        {
+            uint32_t id;
+            glm::ivec2 start;
+            glm::ivec2 goal;
+        };
+
+        struct CachedField
+        {
+            std::shared_ptr<const FlowField> field;
+            uint64_t last_used;
+            uint64_t generation;
+        };
+
+        void RunPaths(const std::vector<PathRequest>& paths);
+        void RunField(glm::ivec2 goal, uint64_t generation);
+
+        const TileCollisionGrid& grid_;
+        JobSystem& jobs_;
+        int max_paths_per_update_;
+        size_t max_cached_fields_;
+        uint32_t next_request_ = 1;
+        uint64_t frame_ = 0;
+        uint64_t field_generation_ = 0;
+        std::vector<PathRequest> queued_{};
+        JobCounter in_flight_{};
+
+        std::mutex mutex_{};
+        std::unordered_map<uint64_t, CachedField> fields_{};
+        std::unordered_map<uint32_t, std::vector<glm::ivec2>> results_{};
+    };
+}
@@ -0,0 +1,506 @@
+#include "bifrost_render.h"
+#include "bifrost_jobs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+
+bool initialized = false;
+bifrost::Shader batch_shader;
+unsigned int batch_vao;
+unsigned int batch_vbo;
+unsigned int batch_ebo;
+size_t batch_ebo_quads = 0;
+
+const char* batch_vs =
+R"(#version 450 core
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 uv;
+layout (location = 2) in vec4 color;
+out vec2 texture_coords;
+out vec4 vertex_color;
+uniform mat4 mvp;
+void main()
+{
+    gl_Position = mvp * vec4(position, 0.0, 1.0);
+    texture_coords = uv;
+    vertex_color = color;
+}
+)";
+
+const char* batch_fs =
+R"(#version 450 core
+in vec2 texture_coords;
+in vec4 vertex_color;
+uniform sampler2D tex;
+out vec4 fragment_color;
+void main()
+{
+    fragment_color = texture(tex, texture_coords) * vertex_color;
+})";
+
+// Stand-ins for textures that only exist on the GL thread, resolved in Execute().
+constexpr uint32_t WHITE_TEXTURE = 0xFFFFFFFE;
+constexpr uint32_t DEBUG_FONT_TEXTURE = 0xFFFFFFFF;
+
+// Queues get a unique id so a thread's cached buffer can't be mistaken for one belonging
+// to a destroyed queue that had the same address.
+std::atomic<uint64_t> next_queue_id{1};
+
+struct CachedBuffer
+{
+    uint64_t queue;
+    void* buffer;
+};
+
+thread_local CachedBuffer cached_buffers[4] = {};
+thread_local int next_cached_buffer = 0;
+
+void InitializeRenderQueue()
+{
+    if (initialized)
+        return;
+
+    initialized = true;
+    batch_shader = bifrost::GenShaderFromSource(batch_vs, batch_fs);
+
+    glGenVertexArrays(1, &batch_vao);
+    glGenBuffers(1, &batch_vbo);
+    glGenBuffers(1, &batch_ebo);
+
+    glBindVertexArray(batch_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, batch_vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch_ebo);
+    // position, uv, packed RGBA8 color
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 20, (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 20, (void*)8);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, 20, (void*)16);
+    glBindVertexArray(0);
+}
+
+uint32_t PackColor(glm::vec4 color)
+{
+    glm::uvec4 c = glm::uvec4(glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f);
+    return c.r | (c.g << 8) | (c.b << 16) | (c.a << 24);
+}
+
+glm::vec2 AngleToRotation(float angle)
+{
+    float radians = glm::radians(angle);
+    return glm::vec2(std::cos(radians), std::sin(radians));
+}
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+RenderQueue::RenderQueue()
+    : id_(next_queue_id.fetch_add(1, std::memory_order_relaxed))
+{
+}
+
+RenderQueue::ThreadBuffer& RenderQueue::LocalBuffer()
+{
+    for (const auto& cached : cached_buffers)
+        if (cached.queue == id_)
+            return *static_cast<ThreadBuffer*>(cached.buffer);
+
+    std::lock_guard lock(mutex_);
+    auto thread = std::this_thread::get_id();
+    ThreadBuffer* buffer = nullptr;
+    for (auto& b : buffers_)
+        if (b->thread == thread)
+            buffer = b.get();
+
+    if (!buffer)
+    {
+        buffers_.push_back(std::make_unique<ThreadBuffer>());
+        buffer = buffers_.back().get();
+        buffer->thread = thread;
+    }
+
+    cached_buffers[next_cached_buffer] = CachedBuffer{id_, buffer};
+    next_cached_buffer = (next_cached_buffer + 1) % 4;
+    return *buffer;
+}
+
+size_t RenderQueue::Size() const
+{
+    std::lock_guard lock(mutex_);
+    size_t size = 0;
+    for (const auto& buffer : buffers_)
+        size += buffer->quads.size();
+    return size;
+}
+
+void RenderQueue::DrawRectangle(int layer, glm::vec2 origin, glm::vec2 size, float angle, glm::vec4 color)
+{
+    Record(Quad{origin, size, AngleToRotation(angle), glm::vec2(0.0f), glm::vec2(1.0f), PackColor(color), WHITE_TEXTURE, 0, layer});
+}
+
+void RenderQueue::DrawRectangle(int layer, glm::vec2 origin, glm::vec2 size, float angle, Texture texture, glm::vec2 source_origin, glm::vec2 source_size, glm::vec4 color)
+{
+    DrawRectangle(layer, origin, size, angle, texture, source_origin, source_size, color, Shader{0});
+}
+
+void RenderQueue::DrawRectangle(int layer, glm::vec2 origin, glm::vec2 size, float angle, Texture texture, glm::vec2 source_origin, glm::vec2 source_size, glm::vec4 color, Shader shader)
+{
+    glm::vec2 texture_size = glm::vec2((float)texture.width, (float)texture.height);
+    glm::vec2 uv_start = source_origin / texture_size;
+    glm::vec2 uv_end = uv_start + source_size / texture_size;
+    Record(Quad{origin, size, AngleToRotation(angle), uv_start, uv_end, PackColor(color), texture.id, shader.id, layer});
+}
+
+glm::vec2 RenderQueue::DrawDebugText(int layer, glm::vec2 origin, float height, glm::vec4 color, std::string_view str)
+{
+    // Same layout as the immediate DrawDebugText, minus wrapping, laid out here so the
+    // recording thread does the work.
+    auto& quads = LocalBuffer().quads;
+    uint32_t packed = PackColor(color);
+    glm::vec2 glyph_size = glm::vec2(height / 12.0f * 7.0f, height);
+    glm::vec2 glyph_offset = glm::vec2(height / 12.0f * 2.5f, height / 6.0f);
+    glm::vec2 uv_size = glm::vec2(7.0f / 112.0f, 12.0f / 72.0f);
+
+    glm::vec2 offset = glm::vec2(0.0f);
+    for (char c : str)
+    {
+        if (c == '\n')
+        {
+            offset.x = 0.0f;
+            offset.y -= height;
+            continue;
+        }
+
+        int index = int(c) - 32;
+        glm::vec2 uv_start = glm::vec2((float)(index % 16), (float)(index / 16)) * uv_size;
+        quads.push_back(Quad{origin + offset + glyph_offset, glyph_size, glm::vec2(1.0f, 0.0f), uv_start, uv_start + uv_size, packed, DEBUG_FONT_TEXTURE, 0, layer});
+        offset.x += height / 12.0f * GetDebugCharWidth(c);
+    }
+
+    return origin + offset;
+}
+
+void RenderQueue::DrawLine(int layer, glm::vec2 begin, glm::vec2 end, float width, glm::vec4 color)
+{
+    // A quad along the line, extended by half the width at each end like the immediate
+    // version's geometry shader.
+    glm::vec2 delta = end - begin;
+    float length = glm::length(delta);
+    glm::vec2 direction = length > 0.0f ? delta / length : glm::vec2(1.0f, 0.0f);
+    Record(Quad{(begin + end) * 0.5f, glm::vec2(length + width, width), glm::vec2(direction.x, -direction.y),
+        glm::vec2(0.0f), glm::vec2(1.0f), PackColor(color), WHITE_TEXTURE, 0, layer});
+}
+
+void RenderQueue::DrawSprites(int layer, Texture texture, std::span<const glm::vec2> origins, std::span<const glm::vec2> sizes,
+                              std::span<const glm::vec4> uv_rects, std::span<const uint32_t> colors)
+{
+    auto& quads = LocalBuffer().quads;
+    size_t count = std::min({origins.size(), sizes.size(), uv_rects.size(), colors.size()});
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::vec4 uv = uv_rects[i];
+        quads.push_back(Quad{origins[i], sizes[i], glm::vec2(1.0f, 0.0f), glm::vec2(uv.x, uv.y), glm::vec2(uv.z, uv.w), colors[i], texture.id, 0, layer});
+    }
+}
+
+void RenderQueue::DrawSprites(int layer, Texture texture, std::span<const glm::vec2> origins, std::span<const glm::vec2> sizes,
+                              std::span<const glm::vec4> uv_rects, std::span<const uint32_t> colors, std::span<const uint32_t> indices)
+{
+    auto& quads = LocalBuffer().quads;
+    for (uint32_t i : indices)
+    {
+        glm::vec4 uv = uv_rects[i];
+        quads.push_back(Quad{origins[i], sizes[i], glm::vec2(1.0f, 0.0f), glm::vec2(uv.x, uv.y), glm::vec2(uv.z, uv.w), colors[i], texture.id, 0, layer});
+    }
+}
+
+void RenderQueue::Execute(Camera2d camera)
+{
+    InitializeRenderQueue();
+
+    merged_.clear();
+    {
+        std::lock_guard lock(mutex_);
+        for (auto& buffer : buffers_)
+        {
+            merged_.insert(merged_.end(), buffer->quads.begin(), buffer->quads.end());
+            buffer->quads.clear();
+        }
+    }
+
+    last_batch_count_ = 0;
+    last_culled_count_ = 0;
+    if (merged_.empty())
+        return;
+
+    // Quads outside the camera's view are dropped here, so nothing recorded off-screen
+    // reaches the vertex buffer.
+    uint32_t font_id = GetDebugFontTexture().id;
+    uint32_t white_id = GetWhiteTexture().id;
+    order_.clear();
+    for (size_t i = 0; i < merged_.size(); i++)
+    {
+        auto& quad = merged_[i];
+        glm::vec2 half = glm::abs(quad.size) * 0.5f;
+        glm::vec2 extent = glm::vec2(std::abs(quad.rotation.x) * half.x + std::abs(quad.rotation.y) * half.y,
+                                     std::abs(quad.rotation.y) * half.x + std::abs(quad.rotation.x) * half.y);
+        if (!IsVisible(camera, Aabb{quad.center - extent, quad.center + extent}))
+            continue;
+
+        if (quad.texture == WHITE_TEXTURE)
+            quad.texture = white_id;
+        else if (quad.texture == DEBUG_FONT_TEXTURE)
+            quad.texture = font_id;
+        if (!quad.shader)
+            quad.shader = batch_shader.id;
+
+        uint64_t layer = (uint64_t)(std::clamp(quad.layer, -32768, 32767) + 32768);
+        uint64_t key = (layer << 48) | ((uint64_t)(quad.shader & 0xFFFFFF) << 24) | (quad.texture & 0xFFFFFF);
+        order_.push_back({key, (uint32_t)i});
+    }
+    last_culled_count_ = (int)(merged_.size() - order_.size());
+    if (order_.empty())
+        return;
+
+    // The index breaks ties, so equal keys keep their recording order.
+    std::sort(order_.begin(), order_.end());
+
+    vertices_.resize(order_.size() * 4);
+    GetJobSystem().ParallelFor(order_.size(), [this](size_t begin, size_t end)
+    {
+        const glm::vec2 corners[4] = {{-0.5f, 0.5f}, {-0.5f, -0.5f}, {0.5f, -0.5f}, {0.5f, 0.5f}};
+        for (size_t i = begin; i < end; i++)
+        {
+            const auto& quad = merged_[order_[i].second];
+            const glm::vec2 uvs[4] = {
+                {quad.uv_start.x, quad.uv_end.y},
+                {quad.uv_start.x, quad.uv_start.y},
+                {quad.uv_end.x, quad.uv_start.y},
+                {quad.uv_end.x, quad.uv_end.y},
+            };
+            for (int c = 0; c < 4; c++)
+            {
+                glm::vec2 p = corners[c] * quad.size;
+                glm::vec2 rotated = glm::vec2(quad.rotation.x * p.x + quad.rotation.y * p.y, -quad.rotation.y * p.x + quad.rotation.x * p.y);
+                vertices_[i * 4 + c] = Vertex{quad.center + rotated, uvs[c], quad.color};
+            }
+        }
+    }, 1024);
+
+    glBindVertexArray(batch_vao);
+
+    if (batch_ebo_quads < order_.size())
+    {
+        batch_ebo_quads = std::max(order_.size(), batch_ebo_quads * 2);
+        std::vector<uint32_t> indices(batch_ebo_quads * 6);
+        for (size_t q = 0; q < batch_ebo_quads; q++)
+        {
+            const uint32_t quad_indices[6] = {0, 1, 2, 2, 3, 0};
+            for (int k = 0; k < 6; k++)
+                indices[q * 6 + k] = (uint32_t)(q * 4) + quad_indices[k];
+        }
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * indices.size(), indices.data(), GL_STATIC_DRAW);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, batch_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices_.size(), vertices_.data(), GL_STREAM_DRAW);
+
+    glDisable(GL_DEPTH_TEST);
+    glActiveTexture(GL_TEXTURE0);
+
+    uint32_t bound_shader = 0;
+    uint32_t bound_texture = 0;
+    size_t batch_start = 0;
+    for (size_t i = 1; i <= order_.size(); i++)
+    {
+        // Flush when the shader or texture changes; a layer change alone can keep batching.
+        uint64_t state_mask = 0xFFFFFFFFFFFFull;
+        if (i < order_.size() && (order_[i].first & state_mask) == (order_[batch_start].first & state_mask))
+            continue;
+
+        const auto& first = merged_[order_[batch_start].second];
+        if (first.shader != bound_shader)
+        {
+            bound_shader = first.shader;
+            glUseProgram(bound_shader);
+            glUniformMatrix4fv(glGetUniformLocation(bound_shader, "mvp"), 1, GL_FALSE, glm::value_ptr(camera.projection));
+            glUniform1i(glGetUniformLocation(bound_shader, "tex"), 0);
+        }
+        if (first.texture != bound_texture)
+        {
+            bound_texture = first.texture;
+            glBindTexture(GL_TEXTURE_2D, bound_texture);
+        }
+
+        glDrawElements(GL_TRIANGLES, (int)((i - batch_start) * 6), GL_UNSIGNED_INT, (void*)(batch_start * 6 * sizeof(uint32_t)));
+        last_batch_count_++;
+        batch_start = i;
+    }
+
+    glBindVertexArray(0);
+}
+
+RenderThread::RenderThread(GLFWwindow* window, int max_frames_in_flight, bool finish_after_swap, int swap_interval)
+    : window_(window)
+    , max_frames_in_flight_(std::clamp(max_frames_in_flight, 1, MAX_FRAMES_IN_FLIGHT))
+    , finish_after_swap_(finish_after_swap)
+    , swap_interval_(swap_interval)
+{
+    for (int i = 0; i < (int)frames_.size(); i++)
+        free_.push_back(i);
+
+    glfwMakeContextCurrent(nullptr);
+    thread_ = std::thread(&RenderThread::Thread, this);
+}
+
+RenderThread::~RenderThread()
+{
+    {
+        std::lock_guard lock(mutex_);
+        running_ = false;
+    }
+    frame_submitted_.notify_all();
+    thread_.join();
+    glfwMakeContextCurrent(window_);
+}
+
+RenderQueue& RenderThread::BeginFrame()
+{
+    double start = glfwGetTime();
+    std::unique_lock lock(mutex_);
+    frame_done_.wait(lock, [this]() { return (int)submitted_.size() < max_frames_in_flight_ && !free_.empty(); });
+    stats_.wait_ms = (glfwGetTime() - start) * 1000.0;
+
+    recording_ = free_.front();
+    free_.pop_front();
+    return frames_[recording_].queue;
+}
+
+void RenderThread::EndFrame(const FrameState& state)
+{
+    if (recording_ < 0)
+        return;
+
+    {
+        std::lock_guard lock(mutex_);
+        frames_[recording_].state = state;
+        submitted_.push_back(recording_);
+        recording_ = -1;
+    }
+    frame_submitted_.notify_one();
+}
+
+void RenderThread::RunOnRenderThread(std::function<void()> fn)
+{
+    {
+        std::lock_guard lock(mutex_);
+        tasks_.push_back(std::move(fn));
+    }
+    frame_submitted_.notify_one();
+}
+
+void RenderThread::SetMaxFramesInFlight(int max_frames_in_flight)
+{
+    {
+        std::lock_guard lock(mutex_);
+        max_frames_in_flight_ = std::clamp(max_frames_in_flight, 1, MAX_FRAMES_IN_FLIGHT);
+    }
+    frame_done_.notify_all();
+}
+
+void RenderThread::SetFinishAfterSwap(bool finish_after_swap)
+{
+    std::lock_guard lock(mutex_);
+    finish_after_swap_ = finish_after_swap;
+}
+
+void RenderThread::SetSwapInterval(int swap_interval)
+{
+    std::lock_guard lock(mutex_);
+    swap_interval_ = swap_interval;
+    swap_interval_changed_ = true;
+}
+
+RenderThreadStats RenderThread::GetStats() const
+{
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+void RenderThread::Thread()
+{
+    glfwMakeContextCurrent(window_);
+
+    std::vector<std::function<void()>> tasks{};
+    while (true)
+    {
+        int index = -1;
+        bool finish = false;
+        int swap_interval = -1;
+        {
+            std::unique_lock lock(mutex_);
+            frame_submitted_.wait(lock, [this]() { return !running_ || !submitted_.empty() || !tasks_.empty(); });
+            if (!running_ && submitted_.empty() && tasks_.empty())
+                break;
+
+            tasks.swap(tasks_);
+            if (!submitted_.empty())
+                index = submitted_.front();
+            finish = finish_after_swap_;
+            if (swap_interval_changed_)
+            {
+                swap_interval = swap_interval_;
+                swap_interval_changed_ = false;
+            }
+        }
+
+        for (auto& task : tasks)
+            task();
+        tasks.clear();
+
+        if (swap_interval >= 0)
+            glfwSwapInterval(swap_interval);
+
+        if (index < 0)
+            continue;
+
+        // The main thread doesn't touch a submitted frame, so it can be drawn unlocked.
+        double start = glfwGetTime();
+        auto& frame = frames_[index];
+        if (frame.state.viewport.x > 0 && frame.state.viewport.y > 0)
+            glViewport(0, 0, frame.state.viewport.x, frame.state.viewport.y);
+        glClearColor(frame.state.clear_color.r, frame.state.clear_color.g, frame.state.clear_color.b, frame.state.clear_color.a);
+        glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        frame.queue.Execute(frame.state.camera);
+
+        glfwSwapBuffers(window_);
+        if (finish)
+            glFinish();
+        double end = glfwGetTime();
+
+        {
+            std::lock_guard lock(mutex_);
+            stats_.input_to_photon_ms = (end - frame.state.input_time) * 1000.0;
+            stats_.average_input_to_photon_ms = stats_.frames == 0
+                ? stats_.input_to_photon_ms
+                : stats_.average_input_to_photon_ms + (stats_.input_to_photon_ms - stats_.average_input_to_photon_ms) * 0.1;
+            stats_.render_ms = (end - start) * 1000.0;
+            stats_.frames++;
+
+            submitted_.pop_front();
+            free_.push_back(index);
+        }
+        frame_done_.notify_all();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+} // namespace bifrost
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "bifrost.h"
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bifrost
+{
+    // Deferred drawing that can be recorded from any thread. Each thread appends to its own
+    // buffer without locking; Execute() on the GL thread merges the buffers, sorts by layer,
+    // then shader, then texture, and draws each run of equal keys with one glDrawElements.
+    // Within a layer, draws are only ordered by recording order when they share a shader
+    // and texture, so put anything that must overlap in a fixed order on separate layers.
+    // Recording must not overlap with Execute(). Use one queue per camera.
+    class RenderQueue
+    {
+    public:
+        RenderQueue();
+
+        RenderQueue(const RenderQueue&) = delete;
+        RenderQueue& operator=(const RenderQueue&) = delete;
+
+        // Same arguments as the immediate DrawRectangle/DrawDebugText/DrawLine, plus a layer;
+        // lower layers are drawn first.
+        void DrawRectangle(int layer, glm::vec2 origin, glm::vec2 size, float angle, glm::vec4 color);
+        void DrawRectangle(int layer, glm::vec2 origin, glm::vec2 size, float angle, Texture texture, glm::vec2 source_origin, glm::vec2 source_size, glm::vec4 color);
+        // shader must take a vec2 position at location 0, vec2 uv at 1 and vec4 color at 2,
+        // with the view projection in a "mvp" uniform and the texture on unit 0.
+        void DrawRectangle(int layer, glm::vec2 origin, glm::vec2 size, float angle, Texture texture, glm::vec2 source_origin, glm::vec2 source_size, glm::vec4 color, Shader shader);
+        glm::vec2 DrawDebugText(int layer, glm::vec2 origin, float height, glm::vec4 color, std::string_view str);
+        void DrawLine(int layer, glm::vec2 begin, glm::vec2 end, float width, glm::vec4 color);
+        // Unrotated quads from one texture, element i of each span making up quad i. uv_rects
+        // hold normalized (start.x, start.y, end.x, end.y) and colors RGBA8 with red in the
+        // low byte, so batches that already keep those skip DrawRectangle's per-call setup.
+        void DrawSprites(int layer, Texture texture, std::span<const glm::vec2> origins, std::span<const glm::vec2> sizes,
+                         std::span<const glm::vec4> uv_rects, std::span<const uint32_t> colors);
+        // Only the quads listed in indices, e.g. the output of CullSprites.
+        void DrawSprites(int layer, Texture texture, std::span<const glm::vec2> origins, std::span<const glm::vec2> sizes,
+                         std::span<const glm::vec4> uv_rects, std::span<const uint32_t> colors, std::span<const uint32_t> indices);
+
+        // GL thread only. Draws and clears everything recorded since the last call, skipping
+        // quads outside camera.view.
+        void Execute(Camera2d camera);
+
+        // Commands recorded since the last Execute(); not exact while other threads record.
+        size_t Size() const;
+        // Draw calls issued by the last Execute().
+        int LastBatchCount() const { return last_batch_count_; }
+        // Quads the last Execute() skipped as off-screen.
+        int LastCulledCount() const { return last_culled_count_; }
+
+    private:
+        struct Quad
+        {
+            glm::vec2 center;
+            glm::vec2 size;
+            glm::vec2 rotation; // cos, sin of the clockwise angle
+            glm::vec2 uv_start;
+            glm::vec2 uv_end;
+            uint32_t color;
+            uint32_t texture;
+            uint32_t shader;
+            int32_t layer;
+        };
+
+        struct Vertex
+        {
+            glm::vec2 position;
+            glm::vec2 uv;
+            uint32_t color;
+        };
+
+        struct ThreadBuffer
+        {
+            std::thread::id thread;
+            std::vector<Quad> quads;
+        };
+
+        ThreadBuffer& LocalBuffer();
+        void Record(const Quad& quad) { LocalBuffer().quads.push_back(quad); }
+
+        uint64_t id_;
+        mutable std::mutex mutex_{};
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers_{};
+
+        std::vector<Quad> merged_{};
+        std::vector<std::pair<uint64_t, uint32_t>> order_{};
+        std::vector<Vertex> vertices_{};
+        int last_batch_count_ = 0;
+        int last_culled_count_ = 0;
+    };
+
+    // Everything the render thread needs to draw a frame besides its queue, copied at
+    // EndFrame() so the main thread is free to change its own state afterwards.
+    struct FrameState
+    {
+        Camera2d camera;
+        glm::vec4 clear_color;
+        glm::ivec2 viewport;    // framebuffer size, or zero to leave the viewport alone
+        double input_time;      // glfwGetTime() when the input behind this frame was polled
+    };
+
+    struct RenderThreadStats
+    {
+        double input_to_photon_ms;          // last frame, from input_time to its swap returning
+        double average_input_to_photon_ms;  // exponential average of the above
+        double render_ms;                   // render thread time for the last frame, including the swap
+        double wait_ms;                     // time the last BeginFrame() spent blocked
+        uint64_t frames;
+    };
+
+    // Moves window's GL context to a dedicated thread that executes each frame's RenderQueue
+    // and swaps, so the main thread can poll input and simulate the next frame while the
+    // previous one is drawn and waits on vsync. Construct it from the thread that owns the
+    // context, after creating any GL resources the game needs, and make no GL calls on that
+    // thread until it is destroyed; use RunOnRenderThread() for later uploads.
+    //
+    // Latency controls: BeginFrame() blocks while max_frames_in_flight frames are waiting to
+    // be drawn or presented. With 1 the next frame is simulated while the last one renders;
+    // 2 also lets recording run a frame ahead, for throughput at the cost of a frame of
+    // latency. finish_after_swap calls glFinish() after every swap so the driver can't queue
+    // frames of its own, and makes input_to_photon_ms include the GPU time.
+    class RenderThread
+    {
+    public:
+        static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+
+        RenderThread(GLFWwindow* window, int max_frames_in_flight = 1, bool finish_after_swap = false, int swap_interval = 1);
+        // Finishes submitted frames and hands the context back to the calling thread.
+        ~RenderThread();
+
+        RenderThread(const RenderThread&) = delete;
+        RenderThread& operator=(const RenderThread&) = delete;
+
+        // Waits for a free frame and returns its empty queue to record into.
+        RenderQueue& BeginFrame();
+        void EndFrame(const FrameState& state);
+
+        // Runs fn on the render thread before it draws the next frame.
+        void RunOnRenderThread(std::function<void()> fn);
+
+        void SetMaxFramesInFlight(int max_frames_in_flight);
+        void SetFinishAfterSwap(bool finish_after_swap);
+        void SetSwapInterval(int swap_interval);
+        RenderThreadStats GetStats() const;
+
+    private:
+        struct Frame
+        {
+            RenderQueue queue;
+            FrameState state;
+        };
+
+        void Thread();
+
+        GLFWwindow* window_;
+        std::array<Frame, MAX_FRAMES_IN_FLIGHT + 1> frames_{};
+        int recording_ = -1;
+
+        mutable std::mutex mutex_{};
+        std::condition_variable frame_submitted_{};
+        std::condition_variable frame_done_{};
+        std::deque<int> free_{};
+        std::deque<int> submitted_{};
+        std::vector<std::function<void()>> tasks_{};
+        int max_frames_in_flight_;
+        bool finish_after_swap_;
+        int swap_interval_;
+        bool swap_interval_changed_ = true;
+        bool running_ = true;
+        RenderThreadStats stats_{};
+        std::thread thread_{};
+    };
+}
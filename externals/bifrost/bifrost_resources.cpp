@@ -0,0 +1,206 @@
+#include "bifrost_resources.h"
+
+#include <algorithm>
+
+namespace
+{
+
+// Drivers pad three-channel formats to four bytes.
+size_t BytesPerPixel(unsigned int internal_format)
+{
+    switch (internal_format)
+    {
+        case GL_R8:         return 1;
+        case GL_RG8:        return 2;
+        case GL_R16F:       return 2;
+        case GL_RG16F:      return 4;
+        case GL_R32F:       return 4;
+        case GL_RGBA16F:    return 8;
+        case GL_RGB16F:     return 8;
+        case GL_RG32F:      return 8;
+        case GL_RGBA32F:    return 16;
+        case GL_RGB32F:     return 16;
+        default:            return 4;
+    }
+}
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+ResourceRegistry::~ResourceRegistry()
+{
+    for (auto& entry : textures_.Items())
+    {
+        Retire(ResourceType::Texture, entry.bytes);
+        current_.textures.push_back(entry);
+    }
+    for (auto& entry : shaders_.Items())
+    {
+        Retire(ResourceType::Shader, entry.bytes);
+        current_.shaders.push_back(entry);
+    }
+    for (auto& entry : framebuffers_.Items())
+    {
+        Retire(ResourceType::Framebuffer, entry.bytes);
+        current_.framebuffers.push_back(entry);
+    }
+
+    for (auto& retired : in_flight_)
+        Delete(retired);
+    Delete(current_);
+}
+
+TextureHandle ResourceRegistry::AddTexture(Texture texture, size_t bytes)
+{
+    if (bytes == 0)
+        bytes = (size_t)texture.width * texture.height * 4;
+    Added(ResourceType::Texture, bytes);
+    return textures_.Add({texture, bytes});
+}
+
+ShaderHandle ResourceRegistry::AddShader(Shader shader)
+{
+    // The closest thing GL offers to a program's size.
+    int binary_length = 0;
+    glGetProgramiv(shader.id, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+    size_t bytes = (size_t)std::max(binary_length, 0);
+    Added(ResourceType::Shader, bytes);
+    return shaders_.Add({shader, bytes});
+}
+
+FramebufferHandle ResourceRegistry::AddFramebuffer(Framebuffer framebuffer, unsigned int internal_format)
+{
+    size_t bytes = (size_t)framebuffer.width * framebuffer.height * BytesPerPixel(internal_format);
+    Added(ResourceType::Framebuffer, bytes);
+    return framebuffers_.Add({framebuffer, bytes});
+}
+
+const Texture* ResourceRegistry::Get(TextureHandle handle) const
+{
+    auto* entry = textures_.Get(handle);
+    return entry ? &entry->resource : nullptr;
+}
+
+const Shader* ResourceRegistry::Get(ShaderHandle handle) const
+{
+    auto* entry = shaders_.Get(handle);
+    return entry ? &entry->resource : nullptr;
+}
+
+const Framebuffer* ResourceRegistry::Get(FramebufferHandle handle) const
+{
+    auto* entry = framebuffers_.Get(handle);
+    return entry ? &entry->resource : nullptr;
+}
+
+void ResourceRegistry::Destroy(TextureHandle handle)
+{
+    Entry<Texture> entry{};
+    if (!textures_.Remove(handle, &entry))
+        return;
+    Retire(ResourceType::Texture, entry.bytes);
+    current_.textures.push_back(entry);
+}
+
+void ResourceRegistry::Destroy(ShaderHandle handle)
+{
+    Entry<Shader> entry{};
+    if (!shaders_.Remove(handle, &entry))
+        return;
+    Retire(ResourceType::Shader, entry.bytes);
+    current_.shaders.push_back(entry);
+}
+
+void ResourceRegistry::Destroy(FramebufferHandle handle)
+{
+    Entry<Framebuffer> entry{};
+    if (!framebuffers_.Remove(handle, &entry))
+        return;
+    Retire(ResourceType::Framebuffer, entry.bytes);
+    current_.framebuffers.push_back(entry);
+}
+
+void ResourceRegistry::EndFrame()
+{
+    if (!current_.textures.empty() || !current_.shaders.empty() || !current_.framebuffers.empty())
+    {
+        current_.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        in_flight_.push_back(std::move(current_));
+        current_ = {};
+    }
+
+    // Fences complete in submission order, so stop at the first one still pending.
+    size_t done = 0;
+    for (; done < in_flight_.size(); done++)
+    {
+        GLenum status = glClientWaitSync(in_flight_[done].fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        Delete(in_flight_[done]);
+    }
+    in_flight_.erase(in_flight_.begin(), in_flight_.begin() + done);
+}
+
+void ResourceRegistry::Flush()
+{
+    glFinish();
+    for (auto& retired : in_flight_)
+        Delete(retired);
+    in_flight_.clear();
+    Delete(current_);
+    current_ = {};
+}
+
+void ResourceRegistry::Added(ResourceType type, size_t bytes)
+{
+    auto& stats = stats_[(int)type];
+    stats.live++;
+    stats.bytes += bytes;
+    stats.peak_bytes = std::max(stats.peak_bytes, stats.bytes + stats.pending_bytes);
+}
+
+void ResourceRegistry::Retire(ResourceType type, size_t bytes)
+{
+    auto& stats = stats_[(int)type];
+    stats.live--;
+    stats.bytes -= bytes;
+    stats.pending++;
+    stats.pending_bytes += bytes;
+}
+
+void ResourceRegistry::Delete(Retired& retired)
+{
+    if (retired.fence)
+        glDeleteSync(retired.fence);
+    retired.fence = nullptr;
+
+    auto deleted = [this](ResourceType type, size_t bytes)
+    {
+        auto& stats = stats_[(int)type];
+        stats.pending--;
+        stats.pending_bytes -= bytes;
+    };
+
+    for (auto& entry : retired.textures)
+    {
+        DestroyTexture(entry.resource);
+        deleted(ResourceType::Texture, entry.bytes);
+    }
+    for (auto& entry : retired.shaders)
+    {
+        DestroyShader(entry.resource);
+        deleted(ResourceType::Shader, entry.bytes);
+    }
+    for (auto& entry : retired.framebuffers)
+    {
+        DestroyFramebuffer(entry.resource);
+        deleted(ResourceType::Framebuffer, entry.bytes);
+    }
+    retired.textures.clear();
+    retired.shaders.clear();
+    retired.framebuffers.clear();
+}
+
+} // namespace bifrost
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "bifrost.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace bifrost
+{
+    // Reference to an object in a HandlePool. A handle goes stale once its object is
+    // removed, and stays stale when the slot is reused; the zero handle is never valid.
+    template<typename T>
+    struct Handle
+    {
+        uint32_t index = 0;
+        uint32_t generation = 0;
+
+        explicit operator bool() const { return generation != 0; }
+        bool operator==(const Handle&) const = default;
+    };
+
+    // Objects packed in one array, addressed through a slot table that checks handle
+    // generations. Removing swaps the last object into the hole, so iterating Items()
+    // touches only live objects but their order isn't stable. Tag picks the handle type,
+    // for pools that store extra data alongside the object handles refer to.
+    template<typename T, typename Tag = T>
+    class HandlePool
+    {
+    public:
+        Handle<Tag> Add(T value)
+        {
+            uint32_t index;
+            if (!free_slots_.empty())
+            {
+                index = free_slots_.back();
+                free_slots_.pop_back();
+            }
+            else
+            {
+                index = (uint32_t)slots_.size();
+                slots_.push_back({0, 1});
+            }
+
+            slots_[index].dense = (uint32_t)items_.size();
+            items_.push_back(std::move(value));
+            item_slots_.push_back(index);
+            return {index, slots_[index].generation};
+        }
+
+        T* Get(Handle<Tag> handle)
+        {
+            if (handle.index >= slots_.size() || slots_[handle.index].generation != handle.generation)
+                return nullptr;
+            return &items_[slots_[handle.index].dense];
+        }
+
+        const T* Get(Handle<Tag> handle) const
+        {
+            return const_cast<HandlePool*>(this)->Get(handle);
+        }
+
+        // Moves the object into removed if given. Returns false for stale handles.
+        bool Remove(Handle<Tag> handle, T* removed = nullptr)
+        {
+            T* item = Get(handle);
+            if (!item)
+                return false;
+            if (removed)
+                *removed = std::move(*item);
+
+            Slot& slot = slots_[handle.index];
+            uint32_t last = (uint32_t)items_.size() - 1;
+            if (slot.dense != last)
+            {
+                items_[slot.dense] = std::move(items_[last]);
+                item_slots_[slot.dense] = item_slots_[last];
+                slots_[item_slots_[last]].dense = slot.dense;
+            }
+            items_.pop_back();
+            item_slots_.pop_back();
+
+            // Generation zero is reserved for the null handle.
+            slot.generation = slot.generation + 1 == 0 ? 1 : slot.generation + 1;
+            free_slots_.push_back(handle.index);
+            return true;
+        }
+
+        size_t Size() const { return items_.size(); }
+        std::span<T> Items() { return items_; }
+        std::span<const T> Items() const { return items_; }
+
+    private:
+        struct Slot
+        {
+            uint32_t dense;
+            uint32_t generation;
+        };
+
+        std::vector<T> items_{};
+        std::vector<uint32_t> item_slots_{};
+        std::vector<Slot> slots_{};
+        std::vector<uint32_t> free_slots_{};
+    };
+
+    using TextureHandle = Handle<Texture>;
+    using ShaderHandle = Handle<Shader>;
+    using FramebufferHandle = Handle<Framebuffer>;
+
+    enum class ResourceType
+    {
+        Texture,
+        Shader,
+        Framebuffer,
+        Count,
+    };
+
+    struct ResourceStats
+    {
+        size_t live;            // objects reachable through handles
+        size_t pending;         // destroyed objects waiting on the GPU
+        size_t bytes;           // estimated video memory of live objects
+        size_t pending_bytes;
+        size_t peak_bytes;      // most bytes live and pending at once
+    };
+
+    // Owns GL objects behind generational handles. Destroy() makes the handle stale at once,
+    // but the GL object is only deleted after the GPU has finished every command submitted
+    // before the next EndFrame(), which fences each frame's destroyed objects. Memory use is
+    // estimated per type from object sizes and formats.
+    //
+    // GL thread only. With a RenderThread, call Destroy() and EndFrame() on the render
+    // thread through RunOnRenderThread().
+    class ResourceRegistry
+    {
+    public:
+        ResourceRegistry() = default;
+        // Deletes everything, pending or not, without waiting.
+        ~ResourceRegistry();
+
+        ResourceRegistry(const ResourceRegistry&) = delete;
+        ResourceRegistry& operator=(const ResourceRegistry&) = delete;
+
+        // Take ownership of objects made with the core Gen*/Load* functions. The byte size of
+        // a texture is estimated as RGBA8 unless given.
+        TextureHandle AddTexture(Texture texture, size_t bytes = 0);
+        ShaderHandle AddShader(Shader shader);
+        FramebufferHandle AddFramebuffer(Framebuffer framebuffer, unsigned int internal_format = GL_RGB);
+
+        TextureHandle LoadTexture(const char* filename) { return AddTexture(bifrost::LoadTexture(filename)); }
+
+        // Null for stale handles.
+        const Texture* Get(TextureHandle handle) const;
+        const Shader* Get(ShaderHandle handle) const;
+        const Framebuffer* Get(FramebufferHandle handle) const;
+
+        // No-ops for stale handles.
+        void Destroy(TextureHandle handle);
+        void Destroy(ShaderHandle handle);
+        void Destroy(FramebufferHandle handle);
+
+        // Call once per frame after submitting its draws: fences this frame's destroyed
+        // objects and deletes the ones whose fence the GPU has passed.
+        void EndFrame();
+        // Waits for the GPU and deletes everything pending, e.g. before a level change.
+        void Flush();
+
+        ResourceStats GetStats(ResourceType type) const { return stats_[(int)type]; }
+
+    private:
+        template<typename T>
+        struct Entry
+        {
+            T resource;
+            size_t bytes;
+        };
+
+        struct Retired
+        {
+            GLsync fence;
+            std::vector<Entry<Texture>> textures;
+            std::vector<Entry<Shader>> shaders;
+            std::vector<Entry<Framebuffer>> framebuffers;
+        };
+
+        void Added(ResourceType type, size_t bytes);
+        void Retire(ResourceType type, size_t bytes);
+        void Delete(Retired& retired);
+
+        HandlePool<Entry<Texture>, Texture> textures_{};
+        HandlePool<Entry<Shader>, Shader> shaders_{};
+        HandlePool<Entry<Framebuffer>, Framebuffer> framebuffers_{};
+
+        Retired current_{};
+        std::vector<Retired> in_flight_{};
+        ResourceStats stats_[(int)ResourceType::Count]{};
+    };
+}
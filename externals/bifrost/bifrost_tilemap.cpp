@@ -0,0 +1,381 @@
+#include "bifrost_tilemap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+bool shader_initialized = false;
+bifrost::Shader tilemap_shader;
+bifrost::Shader index_tilemap_shader;
+unsigned int fullscreen_vao;
+
+const char* tilemap_vs =
+R"(#version 450 core
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec2 uv;
+out vec2 texture_coords;
+uniform mat4 mvp;
+void main()
+{
+    gl_Position = mvp * vec4(position, 0.0, 1.0);
+    texture_coords = uv;
+}
+)";
+
+const char* tilemap_fs =
+R"(#version 450 core
+in vec2 texture_coords;
+uniform vec4 color;
+uniform sampler2D tex;
+out vec4 fragment_color;
+void main()
+{
+    fragment_color = texture(tex, texture_coords) * vec4(color);
+})";
+
+// Full-screen triangle generated from gl_VertexID; each corner carries its world position
+// so the fragment shader can find the tile under it.
+const char* index_tilemap_vs =
+R"(#version 450 core
+out vec2 world_position;
+uniform mat4 inverse_vp;
+void main()
+{
+    vec2 ndc = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    gl_Position = vec4(ndc, 0.0, 1.0);
+    world_position = (inverse_vp * vec4(ndc, 0.0, 1.0)).xy;
+}
+)";
+
+const char* index_tilemap_fs =
+R"(#version 450 core
+in vec2 world_position;
+uniform usampler2D tiles;
+uniform sampler2D tex;
+uniform vec2 origin;
+uniform vec2 tile_draw_size;
+uniform ivec2 map_size;
+uniform vec2 tile_size;
+uniform vec2 stride;
+uniform int columns;
+uniform int tile_count;
+uniform vec4 color;
+out vec4 fragment_color;
+void main()
+{
+    vec2 local = (world_position - origin) / tile_draw_size;
+    ivec2 cell = ivec2(floor(local));
+    if (any(lessThan(cell, ivec2(0))) || any(greaterThanEqual(cell, map_size)))
+        discard;
+
+    int tile = int(texelFetch(tiles, cell, 0).r);
+    if (tile >= tile_count)
+        discard;
+
+    vec2 source = vec2(tile % columns, tile / columns) * stride + fract(local) * tile_size;
+    fragment_color = texelFetch(tex, ivec2(source), 0) * color;
+})";
+
+void InitializeTilemapShader()
+{
+    if (shader_initialized)
+        return;
+
+    shader_initialized = true;
+    tilemap_shader = bifrost::GenShaderFromSource(tilemap_vs, tilemap_fs);
+    index_tilemap_shader = bifrost::GenShaderFromSource(index_tilemap_vs, index_tilemap_fs);
+    glGenVertexArrays(1, &fullscreen_vao);
+}
+
+} // anonymous namespace
+
+namespace bifrost
+{
+
+Tileset GenTileset(Texture texture, glm::vec2 tile_size, glm::vec2 stride)
+{
+    Tileset tileset = {};
+    tileset.texture = texture;
+    tileset.tile_size = tile_size;
+    tileset.stride = stride;
+    // The last column/row has no trailing gap, so count tiles rather than strides.
+    tileset.columns = (int)((texture.width - tile_size.x) / stride.x) + 1;
+    tileset.rows = (int)((texture.height - tile_size.y) / stride.y) + 1;
+    return tileset;
+}
+
+Tilemap::Tilemap(int width, int height, Tileset tileset, glm::vec2 tile_draw_size, glm::vec2 origin, TilemapMode mode)
+    : mode_(mode)
+    , width_(width)
+    , height_(height)
+    , chunks_x_((width + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE)
+    , chunks_y_((height + TILEMAP_CHUNK_SIZE - 1) / TILEMAP_CHUNK_SIZE)
+    , tileset_(tileset)
+    , tile_draw_size_(tile_draw_size)
+    , origin_(origin)
+{
+    tiles_.assign((size_t)width * height, EMPTY_TILE);
+    if (mode_ == TilemapMode::Chunked)
+        chunks_.assign((size_t)chunks_x_ * chunks_y_, Chunk{0, 0, 0, true});
+}
+
+Tilemap::~Tilemap()
+{
+    for (auto& chunk : chunks_)
+    {
+        if (chunk.vao)
+        {
+            glDeleteVertexArrays(1, &chunk.vao);
+            glDeleteBuffers(1, &chunk.vbo);
+        }
+    }
+
+    if (index_texture_)
+        glDeleteTextures(1, &index_texture_);
+}
+
+void Tilemap::MarkDirty(int x0, int y0, int x1, int y1)
+{
+    for (int cy = y0 / TILEMAP_CHUNK_SIZE; cy <= y1 / TILEMAP_CHUNK_SIZE && !chunks_.empty(); cy++)
+        for (int cx = x0 / TILEMAP_CHUNK_SIZE; cx <= x1 / TILEMAP_CHUNK_SIZE; cx++)
+            chunks_[(size_t)cy * chunks_x_ + cx].dirty = true;
+
+    if (dirty_max_.x < dirty_min_.x)
+    {
+        dirty_min_ = glm::ivec2(x0, y0);
+        dirty_max_ = glm::ivec2(x1, y1);
+        return;
+    }
+    dirty_min_ = glm::min(dirty_min_, glm::ivec2(x0, y0));
+    dirty_max_ = glm::max(dirty_max_, glm::ivec2(x1, y1));
+}
+
+void Tilemap::SetTile(int x, int y, uint16_t tile)
+{
+    if (x < 0 || y < 0 || x >= width_ || y >= height_)
+        return;
+
+    auto& current = tiles_[(size_t)y * width_ + x];
+    if (current == tile)
+        return;
+
+    current = tile;
+    MarkDirty(x, y, x, y);
+}
+
+uint16_t Tilemap::GetTile(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= width_ || y >= height_)
+        return EMPTY_TILE;
+    return tiles_[(size_t)y * width_ + x];
+}
+
+void Tilemap::SetTiles(const std::vector<uint16_t>& tiles)
+{
+    if (tiles.size() != tiles_.size())
+        return;
+
+    tiles_ = tiles;
+    MarkDirty(0, 0, width_ - 1, height_ - 1);
+}
+
+void Tilemap::Fill(uint16_t tile)
+{
+    std::fill(tiles_.begin(), tiles_.end(), tile);
+    MarkDirty(0, 0, width_ - 1, height_ - 1);
+}
+
+glm::ivec2 Tilemap::WorldToTile(glm::vec2 position) const
+{
+    glm::vec2 local = (position - origin_) / tile_draw_size_;
+    return glm::ivec2((int)std::floor(local.x), (int)std::floor(local.y));
+}
+
+glm::vec2 Tilemap::TileToWorld(glm::ivec2 tile) const
+{
+    return origin_ + glm::vec2(tile) * tile_draw_size_;
+}
+
+void Tilemap::RebuildChunk(int chunk_x, int chunk_y)
+{
+    auto& chunk = chunks_[(size_t)chunk_y * chunks_x_ + chunk_x];
+    chunk.dirty = false;
+
+    if (!chunk.vao)
+    {
+        glGenVertexArrays(1, &chunk.vao);
+        glGenBuffers(1, &chunk.vbo);
+
+        glBindVertexArray(chunk.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 4, (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 4, (void*)(sizeof(float) * 2));
+        glBindVertexArray(0);
+    }
+
+    glm::vec2 texture_size = glm::vec2((float)tileset_.texture.width, (float)tileset_.texture.height);
+    glm::vec2 uv_size = tileset_.tile_size / texture_size;
+    int tile_count = tileset_.columns * tileset_.rows;
+
+    scratch_.clear();
+
+    int x_end = std::min(width_, (chunk_x + 1) * TILEMAP_CHUNK_SIZE);
+    int y_end = std::min(height_, (chunk_y + 1) * TILEMAP_CHUNK_SIZE);
+    for (int y = chunk_y * TILEMAP_CHUNK_SIZE; y < y_end; y++)
+    {
+        for (int x = chunk_x * TILEMAP_CHUNK_SIZE; x < x_end; x++)
+        {
+            uint16_t tile = tiles_[(size_t)y * width_ + x];
+            if (tile == EMPTY_TILE || tile >= tile_count)
+                continue;
+
+            glm::vec2 p0 = TileToWorld({x, y});
+            glm::vec2 p1 = p0 + tile_draw_size_;
+            glm::vec2 uv0 = glm::vec2((float)(tile % tileset_.columns), (float)(tile / tileset_.columns)) * tileset_.stride / texture_size;
+            glm::vec2 uv1 = uv0 + uv_size;
+
+            const float quad[] = {
+                p0.x, p1.y, uv0.x, uv1.y,
+                p0.x, p0.y, uv0.x, uv0.y,
+                p1.x, p0.y, uv1.x, uv0.y,
+
+                p1.x, p0.y, uv1.x, uv0.y,
+                p1.x, p1.y, uv1.x, uv1.y,
+                p0.x, p1.y, uv0.x, uv1.y,
+            };
+            scratch_.insert(scratch_.end(), std::begin(quad), std::end(quad));
+        }
+    }
+
+    chunk.vertex_count = (int)(scratch_.size() / 4);
+    glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * scratch_.size(), scratch_.data(), GL_STATIC_DRAW);
+}
+
+void Tilemap::Draw(Camera2d camera)
+{
+    Draw(camera, glm::vec4(1.0f));
+}
+
+void Tilemap::Draw(Camera2d camera, glm::vec4 color)
+{
+    InitializeTilemapShader();
+
+    Aabb bounds = {origin_, origin_ + tile_draw_size_ * glm::vec2((float)width_, (float)height_)};
+    if (!IsVisible(camera, bounds))
+        return;
+
+    if (mode_ == TilemapMode::IndexTexture)
+        DrawIndexTexture(camera, color);
+    else
+        DrawChunks(camera, color);
+}
+
+void Tilemap::DrawChunks(Camera2d camera, glm::vec4 color)
+{
+    // A hand-built camera has no view bounds; derive them from its projection. Clamped as
+    // floats, since a far off view doesn't fit in an int.
+    Aabb view = camera.view.max.x < std::numeric_limits<float>::max() ? camera.view : GetViewBounds(camera);
+    glm::vec2 chunk_world_size = tile_draw_size_ * (float)TILEMAP_CHUNK_SIZE;
+    glm::vec2 chunk_max = glm::vec2((float)chunks_x_, (float)chunks_y_);
+    glm::vec2 first = glm::clamp(glm::floor((view.min - origin_) / chunk_world_size), glm::vec2(-1.0f), chunk_max);
+    glm::vec2 last = glm::clamp(glm::floor((view.max - origin_) / chunk_world_size), glm::vec2(-1.0f), chunk_max);
+
+    int cx0 = std::max(0, (int)first.x);
+    int cy0 = std::max(0, (int)first.y);
+    int cx1 = std::min(chunks_x_ - 1, (int)last.x);
+    int cy1 = std::min(chunks_y_ - 1, (int)last.y);
+    if (cx0 > cx1 || cy0 > cy1)
+        return;
+
+    glDisable(GL_DEPTH_TEST);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, tileset_.texture.id);
+
+    glUseProgram(tilemap_shader.id);
+    glUniformMatrix4fv(glGetUniformLocation(tilemap_shader.id, "mvp"), 1, GL_FALSE, glm::value_ptr(camera.projection));
+    glUniform4fv(glGetUniformLocation(tilemap_shader.id, "color"), 1, glm::value_ptr(color));
+
+    for (int cy = cy0; cy <= cy1; cy++)
+    {
+        for (int cx = cx0; cx <= cx1; cx++)
+        {
+            auto& chunk = chunks_[(size_t)cy * chunks_x_ + cx];
+            if (chunk.dirty)
+                RebuildChunk(cx, cy);
+            if (!chunk.vertex_count)
+                continue;
+
+            glBindVertexArray(chunk.vao);
+            glDrawArrays(GL_TRIANGLES, 0, chunk.vertex_count);
+        }
+    }
+
+    glBindVertexArray(0);
+}
+
+void Tilemap::DrawIndexTexture(Camera2d camera, glm::vec4 color)
+{
+    glActiveTexture(GL_TEXTURE1);
+
+    if (!index_texture_)
+    {
+        glGenTextures(1, &index_texture_);
+        glBindTexture(GL_TEXTURE_2D, index_texture_);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_R16UI, width_, height_);
+        dirty_min_ = glm::ivec2(0);
+        dirty_max_ = glm::ivec2(width_ - 1, height_ - 1);
+    }
+    else
+    {
+        glBindTexture(GL_TEXTURE_2D, index_texture_);
+    }
+
+    if (dirty_max_.x >= dirty_min_.x)
+    {
+        // Upload only the changed rectangle, reading rows straight out of tiles_.
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, width_);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, dirty_min_.x, dirty_min_.y,
+            dirty_max_.x - dirty_min_.x + 1, dirty_max_.y - dirty_min_.y + 1,
+            GL_RED_INTEGER, GL_UNSIGNED_SHORT, &tiles_[(size_t)dirty_min_.y * width_ + dirty_min_.x]);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        dirty_min_ = glm::ivec2(0);
+        dirty_max_ = glm::ivec2(-1);
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, tileset_.texture.id);
+
+    unsigned int id = index_tilemap_shader.id;
+    glUseProgram(id);
+    glUniformMatrix4fv(glGetUniformLocation(id, "inverse_vp"), 1, GL_FALSE, glm::value_ptr(glm::inverse(camera.projection)));
+    glUniform1i(glGetUniformLocation(id, "tex"), 0);
+    glUniform1i(glGetUniformLocation(id, "tiles"), 1);
+    glUniform2fv(glGetUniformLocation(id, "origin"), 1, glm::value_ptr(origin_));
+    glUniform2fv(glGetUniformLocation(id, "tile_draw_size"), 1, glm::value_ptr(tile_draw_size_));
+    glUniform2i(glGetUniformLocation(id, "map_size"), width_, height_);
+    glUniform2fv(glGetUniformLocation(id, "tile_size"), 1, glm::value_ptr(tileset_.tile_size));
+    glUniform2fv(glGetUniformLocation(id, "stride"), 1, glm::value_ptr(tileset_.stride));
+    glUniform1i(glGetUniformLocation(id, "columns"), tileset_.columns);
+    glUniform1i(glGetUniformLocation(id, "tile_count"), tileset_.columns * tileset_.rows);
+    glUniform4fv(glGetUniformLocation(id, "color"), 1, glm::value_ptr(color));
+
+    glDisable(GL_DEPTH_TEST);
+    glBindVertexArray(fullscreen_vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+}
+
+} // namespace bifrost
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "bifrost.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace bifrost
+{
+    constexpr int TILEMAP_CHUNK_SIZE = 32;
+    constexpr uint16_t EMPTY_TILE = 0xFFFF;
+
+    // A texture atlas of equally sized tiles laid out on a fixed stride; the difference
+    // between stride and tile_size is the gap between neighbouring tiles in the source image.
+    // Tile index i refers to column i % columns, row i / columns, using the same source
+    // coordinates as DrawRectangle's source_origin.
+    struct Tileset
+    {
+        Texture texture;
+        glm::vec2 tile_size;
+        glm::vec2 stride;
+        int columns;
+        int rows;
+    };
+
+    Tileset GenTileset(Texture texture, glm::vec2 tile_size, glm::vec2 stride);
+
+    enum class TilemapMode
+    {
+        // Static vertex buffer per chunk, culled against the camera.
+        Chunked,
+        // Whole map in an R16UI index texture, drawn as one full-screen pass where the
+        // fragment shader looks up the atlas tile. Constant draw cost for any map size,
+        // up to GL_MAX_TEXTURE_SIZE tiles per side.
+        IndexTexture,
+    };
+
+    // A grid of tile indices drawn from a Tileset; use one Tilemap per layer.
+    // In Chunked mode the map is split into TILEMAP_CHUNK_SIZE x TILEMAP_CHUNK_SIZE chunks,
+    // each with a static vertex buffer that is only rebuilt when one of its tiles changes,
+    // and Draw() skips chunks outside the camera. In IndexTexture mode edits are uploaded
+    // as a single glTexSubImage2D of the changed region on the next Draw().
+    class Tilemap
+    {
+    public:
+        Tilemap(int width, int height, Tileset tileset, glm::vec2 tile_draw_size, glm::vec2 origin = glm::vec2(0.0f), TilemapMode mode = TilemapMode::Chunked);
+        ~Tilemap();
+
+        Tilemap(const Tilemap&) = delete;
+        Tilemap& operator=(const Tilemap&) = delete;
+
+        void SetTile(int x, int y, uint16_t tile);
+        uint16_t GetTile(int x, int y) const;
+        void SetTiles(const std::vector<uint16_t>& tiles);
+        void Fill(uint16_t tile);
+
+        void Draw(Camera2d camera);
+        void Draw(Camera2d camera, glm::vec4 color);
+
+        glm::ivec2 WorldToTile(glm::vec2 position) const;
+        glm::vec2 TileToWorld(glm::ivec2 tile) const;
+
+        int Width() const { return width_; }
+        int Height() const { return height_; }
+        const Tileset& GetTileset() const { return tileset_; }
+        const std::vector<uint16_t>& GetTiles() const { return tiles_; }
+
+    private:
+        struct Chunk
+        {
+            unsigned int vao;
+            unsigned int vbo;
+            int vertex_count;
+            bool dirty;
+        };
+
+        void RebuildChunk(int chunk_x, int chunk_y);
+        void MarkDirty(int x0, int y0, int x1, int y1);
+        void DrawChunks(Camera2d camera, glm::vec4 color);
+        void DrawIndexTexture(Camera2d camera, glm::vec4 color);
+
+        TilemapMode mode_;
+        int width_;
+        int height_;
+        int chunks_x_;
+        int chunks_y_;
+        Tileset tileset_;
+        glm::vec2 tile_draw_size_;
+        glm::vec2 origin_;
+        std::vector<uint16_t> tiles_{};
+        std::vector<Chunk> chunks_{};
+        std::vector<float> scratch_{};
+        unsigned int index_texture_ = 0;
+        glm::ivec2 dirty_min_{0};
+        glm::ivec2 dirty_max_{-1};
+    };
+}
@@ -10,13 +10,18 @@
 #include <imgui.h>
 
 #include <bifrost/bifrost.h>
+#include <bifrost/bifrost_arena.h>
+#include <bifrost/bifrost_archive.h>
+#include <bifrost/bifrost_audio.h>
 #include <bifrost/bifrost_input.h>
 #include <bifrost/bifrost_dungeon.h>
 #include <bifrost/bifrost_collision.h>
-
-#include <miniaudio/miniaudio.h>
+#include <bifrost/bifrost_render.h>
 
 #include <stdio.h>
+#include <string.h>
+#include <memory>
+#include <span>
 #include <vector>
 #include <format>
 
@@ -29,15 +34,22 @@ namespace
 }
 
 #if _WIN32
-int main();
+int main(int argc, char** argv);
 int WinMain()
 {
-    return main();
+    return main(__argc, __argv);
 }
 #endif
 
-int main()
+// Pass --render-thread to draw and swap on a separate thread while the next frame is
+// simulated. The imgui panel is only available in the default single-threaded mode.
+int main(int argc, char** argv)
 {
+    bool use_render_thread = false;
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], "--render-thread") == 0)
+            use_render_thread = true;
+
     glfwSetErrorCallback(GlfwErrorCallback);
 
     if (!glfwInit())
@@ -61,33 +73,32 @@ int main()
     glfwMakeContextCurrent(window);
     gladLoadGL(glfwGetProcAddress);
 
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    
-    ImGui::StyleColorsDark();
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL3_Init("#version 450");
-    
+    if (!use_render_thread)
+    {
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+
+        ImGui::StyleColorsDark();
+        ImGui_ImplGlfw_InitForOpenGL(window, true);
+        ImGui_ImplOpenGL3_Init("#version 450");
+    }
+
     glEnable(GL_MULTISAMPLE);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glEnable(GL_BLEND);
 
 
-    ma_result result;
-    ma_engine engine;
+    // Prefer the packed archive the build writes next to the executable, falling back to
+    // the loose file.
+    bifrost::AssetArchive assets{};
+    std::vector<unsigned char> sound_scratch{};
+    std::span<const unsigned char> sound_data{};
+    if (assets.Open("assets.pak"))
+        sound_data = assets.Load("sample-9s.wav", sound_scratch);
 
-    result = ma_engine_init(NULL, &engine);
-    if (result != MA_SUCCESS) {
-        return result;
-    }
-
-    ma_sound sound;
-    result = ma_sound_init_from_file(&engine, "sample-9s.wav", MA_SOUND_FLAG_DECODE, NULL, NULL, &sound);
-    if (result != MA_SUCCESS) {
-        return result;
-    }
-    //ma_sound_set_pitch(&sound, 1.0f);
-    //ma_sound_start(&sound);
+    // Declared after the archive so it stops streaming before the mapping goes away.
+    bifrost::AudioSystem audio{};
+    bifrost::MusicParams music{.fade_seconds = 1.0f};
 
     auto clear_color = glm::vec4{0.45f, 0.55f, 0.60f, 1.00f};
     auto font_color = glm::vec4{1.0f};
@@ -116,15 +127,32 @@ int main()
     meta_input.AddKeyBind(GLFW_KEY_ESCAPE, "quit");
     meta_input.AddKeyBind(GLFW_KEY_P, "quit");
     meta_input.AddKeyBind(GLFW_KEY_Q, "toggle_info");
+    meta_input.AddKeyBind(GLFW_KEY_S, "toggle_music");
     meta_input.AddMouseButtonBind(GLFW_MOUSE_BUTTON_LEFT, "mouse_select");
     meta_input.BindOnPressed("quit", [&window]() { glfwSetWindowShouldClose(window, GLFW_TRUE); });
-    meta_input.BindOnPressed("toggle_info", [&show_info_panel]() { show_info_panel = !show_info_panel; });
+    meta_input.BindOnPressed("toggle_info", [&show_info_panel, use_render_thread]() { show_info_panel = !show_info_panel && !use_render_thread; });
+    meta_input.BindOnPressed("toggle_music", [&audio, &sound_data, &music]() {
+        if (audio.IsMusicPlaying())
+            audio.StopMusic(music.fade_seconds);
+        else if (!sound_data.empty())
+            audio.PlayMusic(sound_data, music);
+        else
+            audio.PlayMusic("sample-9s.wav", music);
+    });
     meta_input.BindOnPressed("mouse_select", [&dragging]() { dragging = true; });
     meta_input.BindOnReleased("mouse_select", [&dragging]() { dragging = false; });
 
     auto rect_hitbox = bifrost::GenRectHitbox({80.0f, 80.0f});
     glm::vec2 rect_pos = ui_camera.dimensions / 2.0f;
 
+    // Game drawing is recorded into a queue; it is executed right away in single-threaded
+    // mode, or handed to the render thread. Textures above are created first so they live
+    // on the context before it moves.
+    bifrost::RenderQueue local_queue{};
+    std::unique_ptr<bifrost::RenderThread> render_thread{};
+    if (use_render_thread)
+        render_thread = std::make_unique<bifrost::RenderThread>(window);
+
     /********************************
      * 
      * 
@@ -135,50 +163,65 @@ int main()
     while(!glfwWindowShouldClose(window))
     {
 	   // UPDATE
+        bifrost::ResetFrameArenas();
     	double time = glfwGetTime();
         if (!show_info_panel)
             input.PollEvents(window);
         meta_input.PollEvents(window);
 
-	   // RENDER
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
-
-        // Draw game
-    	glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
-        glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-
-        bifrost::DrawDebugText(ui_camera, glm::vec2{10.0f, ui_camera.dimensions.y - (float)font_size}, (float)font_size, font_color, "ABCDEFGHIJKLMNOPQRSTUVWXYZ\nabcdefghijklmnopqrstuvwxyz\n1234567890-=!#%^*()_+[]{};':,.<>/?\\|~");
-
         bifrost::LineIntersectionResult line_hit{};
         if (dragging)
             line_hit = bifrost::GetLineIntersection(rect_hitbox, rect_pos, 0.0f, input.MousePressedAt, input.MouseAt);
 
         bool mouse_over = bifrost::ContainsPoint(rect_hitbox, rect_pos, 0.0f, meta_input.MouseAt);
+
+	   // RENDER
+        auto& queue = render_thread ? render_thread->BeginFrame() : local_queue;
+
+        queue.DrawDebugText(0, glm::vec2{10.0f, ui_camera.dimensions.y - (float)font_size}, (float)font_size, font_color, "ABCDEFGHIJKLMNOPQRSTUVWXYZ\nabcdefghijklmnopqrstuvwxyz\n1234567890-=!#%^*()_+[]{};':,.<>/?\\|~");
+
         auto rect_color = (mouse_over || line_hit.hit) ? glm::vec4(1.0f, 0.0f, 0.0f, 1.0f) : glm::vec4(1.0f);
-        bifrost::DrawRectangle(ui_camera, rect_pos, glm::vec2(80.0f, 80.0f), dungeon_texture, glm::vec2(x * 17.f, y * 17.f), glm::vec2(16.f), rect_color);
-        bifrost::DrawHitbox(ui_camera, rect_hitbox, rect_pos, 0.f, glm::vec3(0.f, 1.f, 0.f));
+        queue.DrawRectangle(0, rect_pos, glm::vec2(80.0f, 80.0f), 0.0f, dungeon_texture, glm::vec2(x * 17.f, y * 17.f), glm::vec2(16.f), rect_color);
+        for (size_t i = 0; i < rect_hitbox.offsets.size(); i++)
+            queue.DrawLine(1, rect_pos + rect_hitbox.offsets[i], rect_pos + rect_hitbox.offsets[(i + 1) % rect_hitbox.offsets.size()], 1.0f, glm::vec4(0.f, 1.f, 0.f, 1.f));
 
         auto tex_size = glm::vec2(12.f * 17.f, 11.f * 17.f);
-        bifrost::DrawRectangle(ui_camera, tex_size / 2.f, tex_size, dungeon_texture);
+        queue.DrawRectangle(0, tex_size / 2.f, tex_size, 0.0f, dungeon_texture, glm::vec2(0.0f), glm::vec2((float)dungeon_texture.width, (float)dungeon_texture.height), glm::vec4(1.0f));
 
         auto box_start = glm::vec2(x, y) * 17.f;
         auto box_end = box_start + glm::vec2(16.f);
-        bifrost::DrawLine(ui_camera, glm::vec2(box_start.x, box_start.y), glm::vec2(box_start.x, box_end.y), 2.0f, glm::vec3(1.f, 0.f, 0.f));
-        bifrost::DrawLine(ui_camera, glm::vec2(box_start.x, box_end.y), glm::vec2(box_end.x, box_end.y), 2.0f, glm::vec3(1.f, 0.f, 0.f));
-        bifrost::DrawLine(ui_camera, glm::vec2(box_end.x, box_end.y), glm::vec2(box_end.x, box_start.y), 2.0f, glm::vec3(1.f, 0.f, 0.f));
-        bifrost::DrawLine(ui_camera, glm::vec2(box_end.x, box_start.y), glm::vec2(box_start.x, box_start.y), 2.0f, glm::vec3(1.f, 0.f, 0.f));
+        queue.DrawLine(1, glm::vec2(box_start.x, box_start.y), glm::vec2(box_start.x, box_end.y), 2.0f, glm::vec4(1.f, 0.f, 0.f, 1.f));
+        queue.DrawLine(1, glm::vec2(box_start.x, box_end.y), glm::vec2(box_end.x, box_end.y), 2.0f, glm::vec4(1.f, 0.f, 0.f, 1.f));
+        queue.DrawLine(1, glm::vec2(box_end.x, box_end.y), glm::vec2(box_end.x, box_start.y), 2.0f, glm::vec4(1.f, 0.f, 0.f, 1.f));
+        queue.DrawLine(1, glm::vec2(box_end.x, box_start.y), glm::vec2(box_start.x, box_start.y), 2.0f, glm::vec4(1.f, 0.f, 0.f, 1.f));
 
-        //bifrost::DrawDebugText(ui_camera, glm::vec2{10.0f}, (float)font_size, font_color, std::format("[{:.1f}s]", time));
+        //queue.DrawDebugText(0, glm::vec2{10.0f}, (float)font_size, font_color, std::format("[{:.1f}s]", time));
 
         if (dragging)
         {
             glm::vec2 start = input.MousePressedAt;
             glm::vec2 end = input.MouseAt;
-            bifrost::DrawLine(ui_camera, start, end, 2.0f, glm::vec3(1.0f));
+            queue.DrawLine(1, start, end, 2.0f, glm::vec4(1.0f));
         }
-        
+
+        if (render_thread)
+        {
+            auto stats = render_thread->GetStats();
+            queue.DrawDebugText(2, glm::vec2{10.0f}, 16.0f, glm::vec4(1.0f), std::format("input to photon {:.1f} ms (avg {:.1f})  render {:.1f} ms  wait {:.1f} ms",
+                stats.input_to_photon_ms, stats.average_input_to_photon_ms, stats.render_ms, stats.wait_ms));
+            render_thread->EndFrame({ui_camera, clear_color, bifrost::GetScreenSize(*window), time});
+            continue;
+        }
+
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+
+        // Draw game
+    	glClearColor(clear_color.x, clear_color.y, clear_color.z, clear_color.w);
+        glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        local_queue.Execute(ui_camera);
+
         // Draw info panel
         if (show_info_panel)
         {
@@ -190,6 +233,8 @@ int main()
             screen_size = bifrost::GetScreenSize(*window);
             ImGui::Text("Resolution: %dx%d", screen_size.x, screen_size.y);
             ImGui::Text("ViewPort: %dx%d", (int)ui_camera.dimensions.x, (int)ui_camera.dimensions.y);
+            auto audio_stats = audio.GetStats();
+            ImGui::Text("Audio: %d voices, %.3f ms mix", audio_stats.active_voices, audio_stats.mix_ms);
             if (ImGui::Button("RESET"))
             {
                 font_size = 48;
@@ -204,12 +249,11 @@ int main()
         glfwSwapBuffers(window);
     }
 
+    render_thread.reset();
+
     glfwDestroyWindow(window);
     glfwTerminate();
 
-    ma_sound_uninit(&sound);
-    ma_engine_uninit(&engine);
-
     return 0;
 }
 
@@ -217,7 +261,10 @@ namespace
 {
 void GlfwFramebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
-    glViewport(0, 0, width, height);
+    // With the render thread running this thread has no context; the viewport travels
+    // with the frame instead.
+    if (glfwGetCurrentContext())
+        glViewport(0, 0, width, height);
     ui_camera = bifrost::GenUICamera(width, height);
 }
    
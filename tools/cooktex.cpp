@@ -0,0 +1,167 @@
+#include <bifrost/bifrost_btex.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#endif
+#include "stb/stb_image.h"
+
+// Cooks an image into a .btex that LoadTexture uploads without decoding.
+//
+//   cooktex <input.png> <output.btex> [--mips] [--premultiply] [--c-array <name>]
+//
+// Color is left as straight alpha, which is how the bifrost draw calls blend. --premultiply
+// multiplies it by alpha and flags the file, so the loaded Texture reports premultiplied.
+// --mips builds the full chain with a box filter. Output is always RGBA8: no block encoder
+// is built in, though LoadTexture uploads the reserved bc7 and etc2 format ids as is.
+// --c-array writes the .btex as a C array instead, for embedding like tilemap_png.h.
+namespace
+{
+    struct Image
+    {
+        int width;
+        int height;
+        std::vector<unsigned char> pixels;
+    };
+
+    void Premultiply(Image& image)
+    {
+        for (size_t i = 0; i < image.pixels.size(); i += 4)
+        {
+            unsigned int alpha = image.pixels[i + 3];
+            for (int c = 0; c < 3; c++)
+                image.pixels[i + c] = (unsigned char)((image.pixels[i + c] * alpha + 127) / 255);
+        }
+    }
+
+    // Averages 2x2 blocks, clamping at the edge for odd sizes.
+    Image Downsample(const Image& source)
+    {
+        Image mip{std::max(source.width / 2, 1), std::max(source.height / 2, 1), {}};
+        mip.pixels.resize((size_t)mip.width * mip.height * 4);
+        for (int y = 0; y < mip.height; y++)
+        {
+            for (int x = 0; x < mip.width; x++)
+            {
+                int x0 = std::min(x * 2, source.width - 1), x1 = std::min(x * 2 + 1, source.width - 1);
+                int y0 = std::min(y * 2, source.height - 1), y1 = std::min(y * 2 + 1, source.height - 1);
+                for (int c = 0; c < 4; c++)
+                {
+                    auto at = [&](int sx, int sy) { return (unsigned int)source.pixels[((size_t)sy * source.width + sx) * 4 + c]; };
+                    mip.pixels[((size_t)y * mip.width + x) * 4 + c] = (unsigned char)((at(x0, y0) + at(x1, y0) + at(x0, y1) + at(x1, y1) + 2) / 4);
+                }
+            }
+        }
+        return mip;
+    }
+
+    void Append(std::vector<unsigned char>& out, const void* data, size_t size)
+    {
+        auto bytes = static_cast<const unsigned char*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    int Usage(const char* program)
+    {
+        fprintf(stderr, "usage: %s <input.png> <output.btex> [--mips] [--premultiply] [--c-array <name>]\n", program);
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+        return Usage(argv[0]);
+
+    bool mips = false;
+    bool premultiply = false;
+    const char* array_name = nullptr;
+    for (int i = 3; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--mips") == 0)
+            mips = true;
+        else if (strcmp(argv[i], "--premultiply") == 0)
+            premultiply = true;
+        else if (strcmp(argv[i], "--format") == 0)
+        {
+            fprintf(stderr, "--format is not supported, no block encoder is built in; output is always rgba8\n");
+            return 1;
+        }
+        else if (strcmp(argv[i], "--c-array") == 0 && i + 1 < argc)
+            array_name = argv[++i];
+        else
+            return Usage(argv[0]);
+    }
+
+    // Same orientation as LoadTexture's stb path, always four channels.
+    Image image{};
+    int channel_count = 0;
+    stbi_set_flip_vertically_on_load(true);
+    unsigned char* data = stbi_load(argv[1], &image.width, &image.height, &channel_count, 4);
+    if (!data)
+    {
+        fprintf(stderr, "could not load %s: %s\n", argv[1], stbi_failure_reason());
+        return 1;
+    }
+    image.pixels.assign(data, data + (size_t)image.width * image.height * 4);
+    stbi_image_free(data);
+
+    if (premultiply)
+        Premultiply(image);
+
+    std::vector<Image> levels{};
+    levels.push_back(std::move(image));
+    while (mips && (levels.back().width > 1 || levels.back().height > 1))
+        levels.push_back(Downsample(levels.back()));
+
+    bifrost::BtexHeader header{bifrost::BTEX_MAGIC, bifrost::BTEX_VERSION, (uint32_t)bifrost::BtexFormat::Rgba8,
+                               (uint32_t)levels[0].width, (uint32_t)levels[0].height, (uint32_t)levels.size(),
+                               premultiply ? (uint32_t)bifrost::BTEX_PREMULTIPLIED : 0u, 0};
+
+    std::vector<bifrost::BtexMip> mip_table{};
+    uint64_t offset = sizeof(header) + sizeof(bifrost::BtexMip) * levels.size();
+    for (const auto& level : levels)
+    {
+        offset = (offset + 15) & ~(uint64_t)15;
+        mip_table.push_back({offset, level.pixels.size()});
+        offset += level.pixels.size();
+    }
+
+    std::vector<unsigned char> out{};
+    Append(out, &header, sizeof(header));
+    Append(out, mip_table.data(), sizeof(bifrost::BtexMip) * mip_table.size());
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        out.resize(mip_table[i].offset, 0);
+        Append(out, levels[i].pixels.data(), levels[i].pixels.size());
+    }
+
+    FILE* file = fopen(argv[2], array_name ? "w" : "wb");
+    if (!file)
+    {
+        fprintf(stderr, "could not open %s for writing\n", argv[2]);
+        return 1;
+    }
+
+    if (array_name)
+    {
+        fprintf(file, "unsigned char %s[] = {", array_name);
+        for (size_t i = 0; i < out.size(); i++)
+            fprintf(file, "%s0x%02x,", i % 16 == 0 ? "\n  " : " ", out[i]);
+        fprintf(file, "\n};\nunsigned int %s_len = %zu;\n", array_name, out.size());
+    }
+    else
+    {
+        fwrite(out.data(), 1, out.size(), file);
+    }
+    fclose(file);
+
+    printf("%s: %dx%d, %zu mips, %zu bytes%s\n", argv[2], header.width, header.height, levels.size(), out.size(),
+           premultiply ? ", premultiplied" : "");
+    return 0;
+}
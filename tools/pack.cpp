@@ -0,0 +1,73 @@
+#include <bifrost/bifrost_archive.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+// Packs every file under a directory into one archive, named by their path relative to
+// it with forward slashes.
+//
+//   pack <output.pak> <directory> [--compress] [--align <bytes>]
+//
+// --compress stores entries as LZ4 where that saves at least an eighth; already compressed
+// formats like PNG stay uncompressed, so they can still be read straight from the mapping.
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s <output.pak> <directory> [--compress] [--align <bytes>]\n", argv[0]);
+        return 1;
+    }
+
+    bool compress = false;
+    uint32_t alignment = 64;
+    for (int i = 3; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--compress") == 0)
+            compress = true;
+        else if (strcmp(argv[i], "--align") == 0 && i + 1 < argc)
+            alignment = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            fprintf(stderr, "unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    namespace fs = std::filesystem;
+    fs::path root = argv[2];
+    if (!fs::is_directory(root))
+    {
+        fprintf(stderr, "%s is not a directory\n", argv[2]);
+        return 1;
+    }
+
+    bifrost::ArchiveWriter writer{};
+    size_t total = 0;
+    int count = 0;
+    for (const auto& file : fs::recursive_directory_iterator(root))
+    {
+        if (!file.is_regular_file())
+            continue;
+
+        std::ifstream stream(file.path(), std::ios::binary);
+        std::vector<unsigned char> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        std::string name = fs::relative(file.path(), root).generic_string();
+        total += data.size();
+        count++;
+        printf("  %-40s %10zu bytes\n", name.c_str(), data.size());
+        writer.Add(std::move(name), std::move(data), compress);
+    }
+
+    if (!writer.Write(argv[1], alignment))
+    {
+        fprintf(stderr, "could not write %s (alignment must be a power of two)\n", argv[1]);
+        return 1;
+    }
+
+    printf("packed %d files, %zu bytes, into %s (%ju bytes)\n", count, total, argv[1], (uintmax_t)fs::file_size(argv[1]));
+    return 0;
+}